@@ -0,0 +1,149 @@
+#include "jobs.h"
+#include <cassert>
+
+//           
+static thread_local const JobSystem* tlsSystem = nullptr;
+static thread_local int tlsSlot = 0;
+static thread_local JobSystem::Task* tlsTask = nullptr;
+
+JobSystem::JobSystem(int threads) : queued(0), stopping(false) {
+    const int n = std::max(threads, 1);
+    for (int i = 0; i < n; i++) {
+        slots.emplace_back(new Slot());
+    }
+    for (int i = 1; i < n; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleep.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int JobSystem::currentSlot() const {
+    return tlsSystem == this ? tlsSlot : 0;
+}
+
+JobSystem::TaskRef JobSystem::create(std::function<void()> fn, std::initializer_list<TaskRef> deps) {
+    TaskRef task = std::make_shared<Task>();
+    task->fn = std::move(fn);
+    for (const TaskRef& dep : deps) {
+        std::lock_guard<std::mutex> lock(dep->mutex);
+        if (!dep->done) {
+            dep->dependents.push_back(task);
+            task->blockers++;
+        }
+    }
+    return task;
+}
+
+void JobSystem::submit(const TaskRef& task) {
+    if (--task->blockers == 0) push(currentSlot(), task);
+}
+
+void JobSystem::spawn(std::function<void()> fn) {
+    assert(tlsTask != nullptr && "spawn outside of a task");
+    TaskRef child = std::make_shared<Task>();
+    child->fn = std::move(fn);
+    child->blockers = 0;
+    child->parent = tlsTask->shared_from_this();
+    tlsTask->unfinished++;
+    push(currentSlot(), std::move(child));
+}
+
+void JobSystem::wait(const TaskRef& task) {
+    const int slot = currentSlot();
+    while (!task->done) {
+        TaskRef work = findWork(slot);
+        if (work) {
+            execute(work);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::push(int slot, TaskRef task) {
+    //              
+    queued++;
+    {
+        std::lock_guard<std::mutex> lock(slots[slot]->mutex);
+        slots[slot]->tasks.push_back(std::move(task));
+    }
+    //   ,       queued  
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    sleep.notify_one();
+}
+
+JobSystem::TaskRef JobSystem::findWork(int slot) {
+    //   -  :       
+    {
+        Slot& own = *slots[slot];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            TaskRef task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued--;
+            return task;
+        }
+    }
+    //  -  :        
+    const int n = static_cast<int>(slots.size());
+    for (int k = 1; k < n; k++) {
+        Slot& victim = *slots[(slot + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            TaskRef task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued--;
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(const TaskRef& task) {
+    Task* saved = tlsTask;
+    tlsTask = task.get();
+    task->fn();
+    tlsTask = saved;
+    finish(task);
+}
+
+void JobSystem::finish(const TaskRef& task) {
+    if (--task->unfinished > 0) return;
+
+    std::vector<TaskRef> ready;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->done = true;
+        ready.swap(task->dependents);
+    }
+    for (TaskRef& dependent : ready) {
+        if (--dependent->blockers == 0) push(currentSlot(), std::move(dependent));
+    }
+    TaskRef parent = std::move(task->parent);
+    if (parent) finish(parent);
+}
+
+void JobSystem::workerLoop(int slot) {
+    tlsSystem = this;
+    tlsSlot = slot;
+    for (;;) {
+        TaskRef task = findWork(slot);
+        if (task) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleep.wait(lock, [this]() { return stopping || queued > 0; });
+        if (stopping && queued == 0) return;
+    }
+}
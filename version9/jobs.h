@@ -0,0 +1,100 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <cstddef>
+#include <algorithm>
+
+//     .     :    
+//  ,            .
+//  0 -    ,      .
+class JobSystem {
+public:
+    struct Task;
+    typedef std::shared_ptr<Task> TaskRef;
+
+    // threads -     , 1 -  ,   ,  
+    explicit JobSystem(int threads);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+
+    static size_t chunkCount(size_t count, size_t grain) { return (count + grain - 1) / grain; }
+
+    //     submit     deps
+    TaskRef create(std::function<void()> fn, std::initializer_list<TaskRef> deps = {});
+    void submit(const TaskRef& task);
+    //       ,   -   
+    void wait(const TaskRef& task);
+    //    :      
+    void spawn(std::function<void()> fn);
+
+    // fn(chunk, begin, end)    [chunk * grain, min((chunk + 1) * grain, count)).
+    //       ,  ,   
+    //     ,     
+    template <class Fn>
+    void parallelFor(size_t count, size_t grain, Fn fn) {
+        const size_t chunks = chunkCount(count, grain);
+        auto chunk = [&](size_t c) { fn(c, c * grain, std::min(count, (c + 1) * grain)); };
+        if (chunks <= 1 || workers.empty()) {
+            for (size_t c = 0; c < chunks; c++) chunk(c);
+            return;
+        }
+        //    :     ,  
+        //    ,   .  
+        // ( ,  )   ,   
+        std::function<void(size_t, size_t)> split = [&](size_t first, size_t last) {
+            while (last - first > 1) {
+                size_t mid = first + (last - first) / 2;
+                spawn([&split, mid, last]() { split(mid, last); });
+                last = mid;
+            }
+            chunk(first);
+        };
+        TaskRef root = create([&]() { split(0, chunks); });
+        submit(root);
+        wait(root);
+    }
+
+private:
+    struct Slot {
+        std::mutex mutex;
+        std::deque<TaskRef> tasks;
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots; // 0 -  , 1.. - 
+    std::vector<std::thread> workers;
+    std::atomic<int> queued; //    
+    std::mutex sleepMutex;
+    std::condition_variable sleep;
+    bool stopping;
+
+    int currentSlot() const;
+    void push(int slot, TaskRef task);
+    TaskRef findWork(int slot);
+    void execute(const TaskRef& task);
+    void finish(const TaskRef& task);
+    void workerLoop(int slot);
+};
+
+struct JobSystem::Task : std::enable_shared_from_this<JobSystem::Task> {
+    std::function<void()> fn;
+    std::atomic<int> unfinished{1};  //      
+    std::atomic<int> blockers{1};    //      submit
+    std::atomic<bool> done{false};
+    TaskRef parent;
+    std::mutex mutex;                //  dependents    done
+    std::vector<TaskRef> dependents; // ,   
+};
+
+#endif // JOBS_H
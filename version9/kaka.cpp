@@ -2,450 +2,530 @@
 #include <cstdlib>
 #include <ctime>
 #include <climits>
+#include <cstdio>
+#include <thread>
 
 
-// Map implementation
-Map::Map(int w, int h) : width(w), height(h) {
-    grid.resize(height, std::vector<char>(width, ' '));
-    generatePath();
-}
-
-void Map::generatePath() {
-    path.clear();
-    const int roadWidth = 3; 
-    
-    #if defined(LEVEL_1)
-    //    3 
-    for (int x = 0; x < width; x++) {
-        for (int dy = -1; dy <= 1; dy++) {
-            int y = height/2 + dy;
-            if(y >= 0 && y < height) {
-                path.push_back({x, y});
-                grid[y][x] = '#';
-            }
-        }
-    }    
-    #elif defined(LEVEL_2)
-    //  2: 
-    bool goingDown = true;
-    int y = height / 3;
-    
-    for (int x = 0; x < width; x++) {
-        path.push_back({x, y});
-        grid[y][x] = '#';
-        
-        if (x % 5 == 0) {
-            y += goingDown ? 1 : -1;
-            if (y <= 1 || y >= height - 2) goingDown = !goingDown;
-        }
-    }
-    
-    #elif defined(LEVEL_3)
-    //  3: 
-    int x = 0, y = height / 2;
-    int dx = 1, dy = 0;
-    int steps = 1;
-    int stepCount = 0;
-    int dirChanges = 0;
-    
-    while (x >= 0 && x < width && y >= 0 && y < height) {
-        path.push_back({x, y});
-        grid[y][x] = '#';
-        
-        x += dx;
-        y += dy;
-        stepCount++;
-        
-        if (stepCount == steps) {
-            stepCount = 0;
-            //  
-            int temp = dx;
-            dx = -dy;
-            dy = temp;
-            dirChanges++;
-            
-            if (dirChanges % 2 == 0) {
-                steps++;
-            }
-        }
-    }
-    
-    #else
-    //   :  
-    for (int x = 0; x < width; x++) {
-        path.push_back({x, height / 2});
-        grid[height / 2][x] = '#';
-    }
-    #endif
-}
-void Map::draw(WINDOW* win) {
+// Map::draw -   Map,   ncurses.
+//   :     generatePath,       
+void Map::draw(WINDOW* win) const {
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
-            mvwaddch(win, y, x, grid[y][x]);
+            mvwaddch(win, y, x, isPath(x, y) ? '#' | COLOR_PAIR(1) : ' ');
         }
     }
 }
 
-bool Map::canPlaceTower(int x, int y) {
-    return grid[y][x] == ' ';
-}
-
-void Map::placeTower(int x, int y) {
-    if (canPlaceTower(x, y)) {
-        grid[y][x] = 'T';
-    }
-}
+// Game implementation
+Game::Game(int width, int height, int level) :
+    jobs(std::max(1, static_cast<int>(std::thread::hardware_concurrency()))),
+    sim(width, height, level, static_cast<uint64_t>(time(nullptr)), &jobs),
+    paused(false),
+    gameSpeed(1),
+    selectedTower(TOWER_BASIC),
+    terrainPad(nullptr),
+    mapWin(nullptr),
+    hudWin(nullptr),
+    minimapWin(nullptr),
+    camX(0),
+    camY(0),
+    viewW(0),
+    viewH(0),
+    minimapW(0),
+    minimapH(0),
+    blockW(1),
+    blockH(1),
+    cursorX(0),
+    cursorY(sim.getMap().getHeight() / 2) {}
 
-// Tower implementations
-Tower::Tower(int x, int y, int dmg, int rng, int c) : 
-    x(x), y(y), damage(dmg), range(rng), cost(c) {}
+void Game::run() {
+    constexpr std::chrono::milliseconds tick(Simulation::TICK_MS);
+    constexpr int maxTicksPerFrame = 16; //       
+    constexpr std::chrono::milliseconds maxFrameBudget(16); //     max
+
+    //      ,     
+    std::thread renderer(&Game::renderLoop, this);
+
+    auto previous = clock::now();
+    clock::duration accumulator(0);
+
+    while (sim.getPlayer().isAlive()) {
+        auto now = clock::now();
+        auto frameTime = now - previous;
+        previous = now;
+
+        applyCommands();
+
+        float alpha = 1.0f;
+        if (paused) {
+            accumulator = clock::duration(0);
+        } else if (gameSpeed == 0) {
+            //  : ,     
+            auto deadline = now + maxFrameBudget;
+            do {
+                sim.update();
+                applyCommands();
+            } while (sim.getPlayer().isAlive() && clock::now() < deadline);
+            accumulator = clock::duration(0);
+        } else {
+            //  :       
+            accumulator += frameTime * gameSpeed;
+            int steps = 0;
+            while (accumulator >= tick && steps < maxTicksPerFrame * gameSpeed && sim.getPlayer().isAlive()) {
+                sim.update();
+                accumulator -= tick;
+                steps++;
+                //     ,     
+                applyCommands();
+            }
+            if (accumulator >= tick) {
+                accumulator = clock::duration(0);
+            }
+            alpha = std::chrono::duration<float>(accumulator) / std::chrono::duration<float>(tick);
+        }
 
-void Tower::attack(Enemy& enemy, std::vector<Projectile>& projectiles) {
-    if (inRange(enemy)) {
-        projectiles.emplace_back(x, y, &enemy, damage);
+        publish(alpha);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); //     
     }
-}
 
-bool Tower::inRange(const Enemy& enemy) {
-    int dx = enemy.getX() - x;
-    int dy = enemy.getY() - y;
-    return (dx * dx + dy * dy) <= (range * range);
+    //     :       
+    publish(1.0f);
+    renderer.join();
 }
 
-int Tower::getCost() const { return cost; }
-int Tower::getX() const { return x; }
-int Tower::getY() const { return y; }
-
-BasicTower::BasicTower(int x, int y) : Tower(x, y, 10, 10, 30) {}
-
-SplashTower::SplashTower(int x, int y) : Tower(x, y, 15, 3, 50) {}
-
-void SplashTower::attack(Enemy& enemy) {
-    if (inRange(enemy)) {
-        enemy.takeDamage(damage);
-    }
-}
+void Game::publish(float alpha) {
+    RenderSnapshot& s = snapshots.writeBuffer();
+    const Map& map = sim.getMap();
+    const auto now = clock::now();
 
-// Enemy implementations
-Enemy::Enemy(int startX, int startY, int hp, int spd, int rwd) :
-    x(startX), y(startY), health(hp), speed(spd), reward(rwd) {}
-
-void Enemy::move(const Map& map) {
-    const auto& path = map.getPath();
-    if (path.empty() || currentPathIndex >= path.size() - 1) return;
-
-    //    
-    if (progress < 1.0f) {
-        progress += 0.1f * speed; //  
-        int nextIndex = currentPathIndex + 1;
-        x = static_cast<int>(path[currentPathIndex].first + 
-                           (path[nextIndex].first - path[currentPathIndex].first) * progress);
-        y = static_cast<int>(path[currentPathIndex].second + 
-                           (path[nextIndex].second - path[currentPathIndex].second) * progress);
-    } else {
-        currentPathIndex++;
-        progress = 0.0f;
+    //       :  ,  
+    s.towers.clear();
+    for (const Tower* t : sim.getTowers()) {
+        s.towers.push_back({t->getX(), t->getY(), t->getArchetype().symbol});
     }
-}
-void Enemy::takeDamage(int dmg) {
-    health -= dmg;
-}
-
-bool Enemy::isAlive() const { return health > 0; }
-int Enemy::getX() const { return x; }
-int Enemy::getY() const { return y; }
-int Enemy::getReward() const { return reward; }
-
-TankEnemy::TankEnemy(int startX, int startY) : 
-    Enemy(startX, startY, 100000, 1, 30) {}
-
-// Player implementation
-Player::Player() : money(100), health(100) {}
-
-bool Player::isAlive() const { return health > 0; }
-bool Player::canAfford(int amount) const { return money >= amount; }
-void Player::spendMoney(int amount) { money -= amount; }
-void Player::takeDamage(int damage) { health -= damage; }
-void Player::addMoney(int amount) { money += amount; }
-
-// WaveManager implementation
-void WaveManager::spawnWave(std::vector<Enemy*>& enemies, int waveNumber) {
-    int numEnemies = 5 + waveNumber * 2;
-    for (int i = 0; i < numEnemies; i++) {
-        if (rand() % 2 == 0) {
-            enemies.push_back(new Enemy(0, 10, 30, 1, 10));
-        } else {
-            enemies.push_back(new TankEnemy(0, 10));
+    s.enemies.clear();
+    const EnemyStore& enemies = sim.getEnemies();
+    for (size_t i = 0; i < enemies.size(); i++) {
+        if (enemies.isAlive(i)) {
+            //      
+            float d = enemies.prevDistance[i] + (enemies.distance[i] - enemies.prevDistance[i]) * alpha;
+            s.enemies.push_back(map.getPath()[map.nodeAt(d)]);
         }
     }
-}
-
-// Game implementation
-Game::Game() : map(150, 55), currentWave(0), cursorX(0), cursorY(map.getHeight()/2) {}
+    s.projectiles.clear();
+    for (const auto& projectile : sim.getProjectiles()) {
+        s.projectiles.push_back({projectile.currentX, projectile.currentY});
+    }
 
-Game::~Game() {
-    //  
-    for (auto tower : towers) {
-        delete tower;
+    //      ,   
+    s.cursorX = cursorX;
+    s.cursorY = cursorY;
+    const Tower* tower = sim.getTowerAt(cursorX, cursorY);
+    s.towerUnderCursor = tower != nullptr;
+    s.overlayRange = -1;
+    if (tower != nullptr) {
+        s.overlayRange = tower->getArchetype().range;
+        s.sellPrice = tower->getCost() / 2;
+        s.policy = tower->policy;
+    } else if (map.canPlaceTower(cursorX, cursorY)) {
+        s.overlayRange = TOWER_ARCHETYPES[selectedTower].range;
     }
-    
-    //  
-    for (auto enemy : enemies) {
-        delete enemy;
+    s.coverage = s.overlayRange >= 0 ? map.pathCellsInRange(cursorX, cursorY, s.overlayRange) : 0;
+
+    s.wave = sim.getCurrentWave();
+    s.money = sim.getPlayer().getMoney();
+    s.health = sim.getPlayer().getHealth();
+    s.paused = paused;
+    s.gameSpeed = gameSpeed;
+    s.selectedTower = selectedTower;
+    s.flash = now < flashUntil;
+    if (now < messageUntil) {
+        s.message = message;
+    } else {
+        s.message.clear();
     }
-}
+    s.gameOver = !sim.getPlayer().isAlive();
 
-bool Game::enemyReachedBase(const Enemy& enemy) const {
-    const auto& path = map.getPath();
-    return !path.empty() && enemy.getX() == path.back().first && enemy.getY() == path.back().second;
+    snapshots.publish();
 }
-void Game::run() {
-    nodelay(stdscr, TRUE);
+
+void Game::renderLoop() {
     curs_set(0);
     start_color();
     init_pair(1, COLOR_WHITE, COLOR_BLACK);
     init_pair(2, COLOR_RED, COLOR_BLACK);
-
-    auto lastUpdate = std::chrono::steady_clock::now();
-    auto lastEnemyMove = lastUpdate;
-    constexpr std::chrono::milliseconds frameDelay(50); // 50ms   
-    constexpr std::chrono::milliseconds enemyMoveInterval(200); // 200ms   
-
-    while (player.isAlive()) {
-        auto now = std::chrono::steady_clock::now();
-        
-        handleInput();
-
-        //   
-        if (now - lastUpdate >= frameDelay) {
-            update();
-            lastUpdate = now;
+    initLayers();
+
+    for (;;) {
+        readInput();
+
+        // ,      
+        if (snapshots.update()) {
+            const RenderSnapshot& s = snapshots.readBuffer();
+            if (s.gameOver) {
+                nodelay(hudWin, FALSE);
+                curs_set(1);
+                //     :     ,   
+                char text[64];
+                int len = std::snprintf(text, sizeof(text), "Game Over! Final Wave: %d", s.wave);
+                int row = std::min(10, viewH - 1);
+                int col = std::max(0, std::min(10, viewW - len));
+                mvwaddnstr(mapWin, row, col, text, viewW - col);
+                wrefresh(mapWin);
+                wgetch(hudWin);
+                closeLayers();
+                return;
+            }
+            render(s);
         }
+        napms(5);
+    }
+}
 
-        //     
-        if (now - lastEnemyMove >= enemyMoveInterval) {
-            moveEnemies();
-            lastEnemyMove = now;
+void Game::readInput() {
+    //   ,    :    .
+    //       
+    Command move = {CMD_MOVE_CURSOR, 0, 0};
+    for (int ch = wgetch(hudWin); ch != ERR; ch = wgetch(hudWin)) {
+        Command cmd = {CMD_MOVE_CURSOR, 0, 0};
+        switch (ch) {
+            case KEY_UP: move.dy--; continue;
+            case KEY_DOWN: move.dy++; continue;
+            case KEY_LEFT: move.dx--; continue;
+            case KEY_RIGHT: move.dx++; continue;
+            case 't': cmd.type = CMD_BUILD; break;
+            case 's': cmd.type = CMD_SELL; break;
+            case 'c': cmd.type = CMD_CYCLE_POLICY; break;
+            case 'g': cmd.type = CMD_CYCLE_TOWER; break;
+            case 'p': cmd.type = CMD_PAUSE; break;
+            case 'f': cmd.type = CMD_SPEED; break;
+            case 'q': cmd.type = CMD_QUIT; break;
+            default: continue;
         }
+        //       
+        if (move.dx != 0 || move.dy != 0) {
+            commands.push(move);
+            move.dx = move.dy = 0;
+        }
+        commands.push(cmd); //  -  ,   
+    }
+    if (move.dx != 0 || move.dy != 0) {
+        commands.push(move);
+    }
+}
 
-        render();
-        napms(10); //     
+void Game::applyCommands() {
+    Command cmd;
+    while (commands.pop(cmd)) {
+        handleCommand(cmd);
     }
-   
-    nodelay(stdscr, FALSE);
-    curs_set(1);
-    mvprintw(10, 10, "Game Over! Final Wave: %d", currentWave);
-    refresh();
-    getch();
 }
 
-void Game::handleInput() {
-    int ch = getch();
-    switch (ch) {
-        case KEY_UP:
-            if (cursorY > 0) cursorY--;
+void Game::handleCommand(const Command& cmd) {
+    switch (cmd.type) {
+        case CMD_MOVE_CURSOR:
+            cursorX = std::min(std::max(cursorX + cmd.dx, 0), sim.getMap().getWidth() - 1);
+            cursorY = std::min(std::max(cursorY + cmd.dy, 0), sim.getMap().getHeight() - 1);
             break;
             
-        case KEY_DOWN:
-            if (cursorY < map.getHeight() - 1) cursorY++;
-            break;
+        case CMD_BUILD: {  //  
+            if (sim.getTowerAt(cursorX, cursorY) != nullptr) break;
             
-        case KEY_LEFT:
-            if (cursorX > 0) cursorX--;
-            break;
-            
-        case KEY_RIGHT:
-            if (cursorX < map.getWidth() - 1) cursorX++;
-            break;
-            
-        case 't': {  //  
-            if (getTowerAt(cursorX, cursorY) != nullptr) break;
-            
-            if (map.canPlaceTower(cursorX, cursorY)) {
-                if (player.canAfford(30)) {
-                    towers.push_back(new BasicTower(cursorX, cursorY));
-                    map.placeTower(cursorX, cursorY);
-                    player.spendMoney(30);
-                } else {
-                    mvprintw(3, 0, "Not enough gold! Need: 30");
-                    refresh();
+            if (sim.getMap().canPlaceTower(cursorX, cursorY)) {
+                if (!sim.buildTower(cursorX, cursorY, selectedTower)) {
+                    showMessage("Not enough gold! Need: " + std::to_string(TOWER_ARCHETYPES[selectedTower].cost));
                 }
             }
             break;
         }
         
-        case 's': {  //  
-            Tower* tower = getTowerAt(cursorX, cursorY);
-            if (tower != nullptr) {
-                player.addMoney(tower->getCost() / 2);
-                map.removeTower(cursorX, cursorY);
-                towers.erase(std::remove(towers.begin(), towers.end(), tower), towers.end());
-                delete tower;
+        case CMD_SELL: {  //  
+            if (sim.sellTower(cursorX, cursorY) >= 0) {
                 flash();
             }
             break;
         }
         
-        case 'q':
-            player.takeDamage(100);
+        case CMD_CYCLE_POLICY: {  //       
+            const Tower* tower = sim.getTowerAt(cursorX, cursorY);
+            if (tower != nullptr) {
+                sim.setTowerPolicy(cursorX, cursorY,
+                    static_cast<TargetPolicy>((tower->policy + 1) % TARGET_POLICY_COUNT));
+            }
+            break;
+        }
+            
+        case CMD_CYCLE_TOWER:  //   
+            selectedTower = static_cast<TowerType>((selectedTower + 1) % TOWER_TYPE_COUNT);
+            break;
+            
+        case CMD_PAUSE:
+            togglePause();
+            break;
+            
+        case CMD_SPEED:
+            cycleSpeed();
+            break;
+            
+        case CMD_QUIT:
+            sim.getPlayer().takeDamage(100);
             break;
     }
 }
-void Game::moveEnemies() {
-    for (auto& enemy : enemies) {
-        enemy->move(map);
-        if (enemyReachedBase(*enemy)) {
-            player.takeDamage(10);
-        }
+void Game::cycleSpeed() {
+    switch (gameSpeed) {
+        case 1: gameSpeed = 2; break;
+        case 2: gameSpeed = 4; break;
+        case 4: gameSpeed = 0; break;
+        default: gameSpeed = 1; break;
     }
 }
 
-void Game::update() {
-    //   
-    if (enemies.empty()) {
-        currentWave++;
-        waveManager.spawnWave(enemies, currentWave);
+void Game::initLayers() {
+    const Map& map = sim.getMap();
+    const int W = map.getWidth();
+    const int H = map.getHeight();
+
+    //  -     pad
+    terrainPad = newpad(H, W);
+    map.draw(terrainPad);
+
+    //    
+    for (int x = 0; x < W; x++) {
+        mvwaddch(terrainPad, 0, x, (x == 0 || x == W-1) ? '+' : '-');
+        mvwaddch(terrainPad, H-1, x, (x == 0 || x == W-1) ? '+' : '-');
     }
 
-    //  
-    for (auto& enemy : enemies) {
-        enemy->move(map);
-        if (enemyReachedBase(*enemy)) {
-            player.takeDamage(10);
-        }
+    //  
+    for (int y = 1; y < H-1; y++) {
+        mvwaddch(terrainPad, y, 0, '|');
+        mvwaddch(terrainPad, y, W-1, '|');
     }
 
-    //  
-    for (auto& tower : towers) {
-        for (auto& enemy : enemies) {
-            if (enemy->isAlive() && tower->inRange(*enemy)) {
-                tower->attack(*enemy, projectiles);
+    //   HUD;    ,    - 
+    clear();
+    refresh();
+    const int rows = std::max(1, LINES - HUD_ROWS);
+    int cols = COLS;
+    if (W > COLS || H > rows) {
+        minimapW = std::max(1, std::min(MINIMAP_WIDTH, COLS / 4));
+        //     ,  
+        minimapH = std::max(1, std::min(rows, (minimapW * H / W + 1) / 2));
+        blockW = (W + minimapW - 1) / minimapW;
+        blockH = (H + minimapH - 1) / minimapH;
+        minimapW = (W + blockW - 1) / blockW;
+        minimapH = (H + blockH - 1) / blockH;
+        cols = std::max(1, COLS - minimapW - 1);
+        minimapWin = newwin(minimapH, minimapW, HUD_ROWS, COLS - minimapW);
+
+        minimapPath.assign(static_cast<size_t>(minimapW) * minimapH, 0);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                if (map.isPath(x, y)) minimapPath[static_cast<size_t>(y / blockH) * minimapW + x / blockW] = 1;
             }
         }
     }
-    
-    updateProjectiles();
-    //   
-    enemies.erase(std::remove_if(enemies.begin(), enemies.end(),
-        [this](Enemy* e) {
-            if (!e->isAlive()) {
-                player.addMoney(e->getReward());
-                delete e;
-                return true;
-            }
-            return false;
-        }), enemies.end());
+    viewW = std::min(W, cols);
+    viewH = std::min(H, rows);
+
+    hudWin = newwin(HUD_ROWS, COLS, 0, 0);
+    mapWin = newwin(viewH, viewW, HUD_ROWS, 0);
+    keypad(hudWin, TRUE);
+    nodelay(hudWin, TRUE);
+
+    frame.resize(static_cast<size_t>(viewW) * viewH);
+    followCursor(cursorX, cursorY);
+    resetView();
 }
 
-void Game::updateProjectiles() {
-    auto it = projectiles.begin();
-    while (it != projectiles.end()) {
-        //  
-        it->progress += projectileSpeed;
-        Enemy* target = it->target;
-        
-        if (target && target->isAlive()) {
-            //   
-            int dx = target->getX() - it->startX;
-            int dy = target->getY() - it->startY;
-            
-            it->currentX = it->startX + static_cast<int>(dx * it->progress);
-            it->currentY = it->startY + static_cast<int>(dy * it->progress);
-            
-            //   
-            if (it->progress >= 1.0f) {
-                target->takeDamage(it->damage);
-                it = projectiles.erase(it);
-            } else {
-                ++it;
-            }
-        } else {
-            //   -  
-            it = projectiles.erase(it);
+void Game::closeLayers() {
+    if (minimapWin != nullptr) delwin(minimapWin);
+    delwin(hudWin);
+    delwin(mapWin);
+    delwin(terrainPad);
+    hudWin = mapWin = terrainPad = minimapWin = nullptr;
+}
+
+void Game::followCursor(int x, int y) {
+    //     margin     
+    const Map& map = sim.getMap();
+    const int marginX = std::min(4, viewW / 4);
+    const int marginY = std::min(4, viewH / 4);
+    if (x < camX + marginX) camX = x - marginX;
+    if (x >= camX + viewW - marginX) camX = x - viewW + marginX + 1;
+    if (y < camY + marginY) camY = y - marginY;
+    if (y >= camY + viewH - marginY) camY = y - viewH + marginY + 1;
+    camX = std::max(0, std::min(camX, map.getWidth() - viewW));
+    camY = std::max(0, std::min(camY, map.getHeight() - viewH));
+}
+
+void Game::resetView() {
+    //      pad:         
+    for (int y = 0; y < viewH; y++) {
+        for (int x = 0; x < viewW; x++) {
+            frame[static_cast<size_t>(y) * viewW + x] = terrainAt(camX + x, camY + y);
         }
     }
+    screen = frame;
+    copywin(terrainPad, mapWin, camY, camX, 0, 0, viewH - 1, viewW - 1, FALSE);
+    prevTouched.clear();
 }
 
-void Game::render() {
-    clear();
-    
-    //   
-    const int W = map.getWidth();
-    const int H = map.getHeight();
-    
-    //    
-    for (int x = 0; x < W; x++) {
-        mvaddch(0, x, (x == 0 || x == W-1) ? '+' : '-');
-        mvaddch(H-1, x, (x == 0 || x == W-1) ? '+' : '-');
+void Game::put(int x, int y, chtype ch) {
+    //  ; ,    , 
+    x -= camX;
+    y -= camY;
+    if (x < 0 || x >= viewW || y < 0 || y >= viewH) return;
+    uint32_t i = static_cast<uint32_t>(y) * viewW + x;
+    frame[i] = ch;
+    touched.push_back(i);
+}
+
+void Game::drawMinimap(const RenderSnapshot& s) {
+    //  -     ,    
+    enum { MARK_TOWER = 1, MARK_ENEMY = 2 };
+    minimapMarks.assign(minimapPath.size(), 0);
+    for (const auto& t : s.towers) {
+        minimapMarks[static_cast<size_t>(t.y / blockH) * minimapW + t.x / blockW] |= MARK_TOWER;
     }
-    
-    //  
-    for (int y = 1; y < H-1; y++) {
-        mvaddch(y, 0, '|');
-        mvaddch(y, W-1, '|');
+    for (const auto& point : s.enemies) {
+        minimapMarks[static_cast<size_t>(point.second / blockH) * minimapW + point.first / blockW] |= MARK_ENEMY;
     }
 
-    //    Map::path
-    for (const auto& point : map.getPath()) {
-        if (point.first > 0 && point.first < W-1 && 
-            point.second > 0 && point.second < H-1) {
-            mvaddch(point.second, point.first, '#' | COLOR_PAIR(1));
+    for (int y = 0; y < minimapH; y++) {
+        for (int x = 0; x < minimapW; x++) {
+            size_t i = static_cast<size_t>(y) * minimapW + x;
+            chtype ch = ' ';
+            if (minimapMarks[i] & MARK_ENEMY) {
+                ch = 'e' | COLOR_PAIR(2);
+            } else if (minimapMarks[i] & MARK_TOWER) {
+                ch = 'T';
+            } else if (minimapPath[i]) {
+                ch = '#' | COLOR_PAIR(1);
+            }
+            //   
+            bool visible = (x + 1) * blockW > camX && x * blockW < camX + viewW &&
+                           (y + 1) * blockH > camY && y * blockH < camY + viewH;
+            mvwaddch(minimapWin, y, x, visible ? ch | A_REVERSE : ch);
         }
     }
+    wnoutrefresh(minimapWin);
+}
+
+void Game::render(const RenderSnapshot& s) {
+    const Map& map = sim.getMap();
+    const int W = map.getWidth();
+    const int H = map.getHeight();
+
+    const int oldCamX = camX;
+    const int oldCamY = camY;
+    followCursor(s.cursorX, s.cursorY);
+    if (camX != oldCamX || camY != oldCamY) {
+        resetView();
+    }
     
+    //  :   
+    map.forEachCellInRange(s.cursorX, s.cursorY, s.overlayRange, [&](int x, int y) {
+        if (x > 0 && x < W-1 && y > 0 && y < H-1 && !map.isPath(x, y)) {
+            put(x, y, '.' | A_DIM);
+        }
+    });
+
     //  
-    for (auto& tower : towers) {
-        int x = tower->getX();
-        int y = tower->getY();
-        if (x > 0 && x < W-1 && y > 0 && y < H-1) {
-            mvaddch(y, x, 'T' | A_BOLD);
+    for (const auto& t : s.towers) {
+        if (t.x > 0 && t.x < W-1 && t.y > 0 && t.y < H-1) {
+            put(t.x, t.y, t.symbol | A_BOLD);
         }
     }
     
     //  
-    for (auto& enemy : enemies) {
-        if (enemy->isAlive()) {
-            int x = enemy->getX();
-            int y = enemy->getY();
-            if (x > 0 && x < W-1 && y > 0 && y < H-1) {
-                mvaddch(y, x, 'E' | COLOR_PAIR(2));
-            }
+    for (const auto& point : s.enemies) {
+        int x = point.first;
+        int y = point.second;
+        if (x > 0 && x < W-1 && y > 0 && y < H-1) {
+            put(x, y, 'E' | COLOR_PAIR(2));
         }
     }
         //  
-    for (const auto& projectile : projectiles) {
-        if (projectile.currentX >= 0 && projectile.currentX < map.getWidth() &&
-            projectile.currentY >= 0 && projectile.currentY < map.getHeight()) {
-            mvaddch(projectile.currentY, projectile.currentX, '*');
-        }
+    for (const auto& projectile : s.projectiles) {
+        put(projectile.first, projectile.second, '*');
     }
     
     //  
-    if (cursorX > 0 && cursorX < W-1 && 
-        cursorY > 0 && cursorY < H-1) {
-        mvaddch(cursorY, cursorX, '+' | A_BOLD);
+    if (s.cursorX > 0 && s.cursorX < W-1 && 
+        s.cursorY > 0 && s.cursorY < H-1) {
+        put(s.cursorX, s.cursorY, s.flash ? ' ' | A_REVERSE : '+' | A_BOLD);
     }
+
+    //  ,       ,   .
+    //       frame    
+    auto emit = [&](uint32_t i) {
+        if (screen[i] != frame[i]) {
+            mvwaddch(mapWin, static_cast<int>(i / viewW), static_cast<int>(i % viewW), frame[i]);
+            screen[i] = frame[i];
+        }
+    };
+    for (uint32_t i : prevTouched) emit(i);
+    for (uint32_t i : touched) emit(i);
+    for (uint32_t i : touched) {
+        frame[i] = terrainAt(camX + static_cast<int>(i % viewW), camY + static_cast<int>(i / viewW));
+    }
+    prevTouched.swap(touched);
+    touched.clear();
+    wnoutrefresh(mapWin);
+
+    if (minimapWin != nullptr) {
+        drawMinimap(s);
+    }
+
         //  
-    mvprintw(0, 0, "Wave: %d Money: %d Health: %d", 
-             currentWave, player.getMoney(), player.getHealth());
-    mvprintw(2, 0, "T: Build | S: Sell | Q: Quit");
-    
-    //      
-    Tower* tower = getTowerAt(cursorX, cursorY);
-    if (tower != nullptr) {
-        mvprintw(3, 0, "Sell for: %d gold", tower->getCost() / 2);
+    char line[256];
+    std::string hud[HUD_ROWS];
+    std::snprintf(line, sizeof(line), "Wave: %d Money: %d Health: %d", s.wave, s.money, s.health);
+    hud[0] = line;
+    if (s.paused) {
+        std::snprintf(line, sizeof(line), "Speed: paused");
+    } else if (s.gameSpeed == 0) {
+        std::snprintf(line, sizeof(line), "Speed: max");
+    } else {
+        std::snprintf(line, sizeof(line), "Speed: %dx", s.gameSpeed);
     }
-    
+    hud[0].resize(45, ' ');
+    hud[0] += line;
+
     //   
-    #if defined(LEVEL_1)
-    mvprintw(1, 0, "Level: Straight path");
-    #elif defined(LEVEL_2)
-    mvprintw(1, 0, "Level: Zigzag");
-    #elif defined(LEVEL_3)
-    mvprintw(1, 0, "Level: Spiral");
-    #else
-    mvprintw(1, 0, "Level: Default");
-    #endif
+    std::snprintf(line, sizeof(line), "Level: %s", map.getLevelName());
+    hud[1] = line;
+    std::snprintf(line, sizeof(line), "T: Build %s (%d) | G: Tower type | S: Sell | P: Pause | F: Speed | Q: Quit",
+                  TOWER_ARCHETYPES[s.selectedTower].name, TOWER_ARCHETYPES[s.selectedTower].cost);
+    hud[2] = line;
     
-    refresh();
+    // ,      ,  -    
+    if (!s.message.empty()) {
+        hud[3] = s.message;
+    } else if (s.towerUnderCursor) {
+        std::snprintf(line, sizeof(line), "Sell for: %d gold | C: Target %s | Covers: %d path cells", s.sellPrice,
+                      TARGET_POLICY_NAMES[s.policy], s.coverage);
+        hud[3] = line;
+    } else if (s.overlayRange >= 0) {
+        std::snprintf(line, sizeof(line), "Covers: %d path cells", s.coverage);
+        hud[3] = line;
+    }
+
+    bool hudChanged = false;
+    for (int row = 0; row < HUD_ROWS; row++) {
+        if (hud[row] != hudLines[row]) {
+            hudLines[row] = hud[row];
+            hudChanged = true;
+        }
+    }
+    if (hudChanged) {
+        werase(hudWin);
+        for (int row = 0; row < HUD_ROWS; row++) {
+            mvwaddnstr(hudWin, row, 0, hudLines[row].c_str(), getmaxx(hudWin));
+        }
+        wnoutrefresh(hudWin);
+    }
+
+    doupdate();
 }
\ No newline at end of file
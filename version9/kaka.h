@@ -4,187 +4,130 @@
 
 #include <ncurses.h>
 #include <vector>
+#include <string>
 #include <algorithm>
 #include <chrono>
-
-// Forward declarations
-class Enemy;
-class Player;
-struct WaveInfo {
-    int totalEnemies;
-    float spawnInterval;
-    std::vector<std::pair<EnemyType, int>> enemyTypes; //   
-};
-
-class WaveManager {
-private:
-    std::vector<WaveInfo> waves;
-    int currentWave = 0;
-    int spawnedEnemies = 0;
-    float timeSinceLastSpawn = 0.0f;
-    bool isSpawning = false;
-
-public:
-    void initWaves();
-    void startNextWave();
-    void update(float deltaTime, std::vector<Enemy*>& enemies);
-    bool isWaveInProgress() const { return isSpawning || !enemies.empty(); }
-};
-
-struct Projectile {
-    int startX, startY;   //  
-    int currentX, currentY;//  
-    Enemy* target;        // 
-    float progress;        //   (0.0 - 1.0)
-    int damage;            // 
-    
-    Projectile(int sx, int sy, Enemy* t, int dmg) 
-        : startX(sx), startY(sy), target(t), progress(0.0f), damage(dmg) {
-        currentX = sx;
-        currentY = sy;
-    }
-};
-
-class Map {
-private:
-    int width, height;
-    std::vector<std::vector<char>> grid;
-    std::vector<std::pair<int, int>> path;
-
-public:
-    Map(int w, int h);
-    void generatePath();
-    void draw(WINDOW* win);
-    bool canPlaceTower(int x, int y);
-    void placeTower(int x, int y);
-    int getWidth() const { return width; }
-    int getHeight() const { return height; }
-    const std::vector<std::pair<int, int>>& getPath() const { return path; }
-    void removeTower(int x, int y) {
-        if (x >= 0 && x < width && y >= 0 && y < height) {
-            grid[y][x] = ' '; 
-        }
-    }
-};
-
-class Tower {
-protected:
-    int x, y;
-    int damage;
-    int range;
-    int cost;
-
-public:
-    Tower(int x, int y, int dmg, int rng, int c);
-    virtual void attack(Enemy& enemy, std::vector<Projectile>& projectiles);
-    bool inRange(const Enemy& enemy);
-    int getCost() const;
-    int getX() const;
-    int getY() const;
+#include "sim.h"
+#include "triplebuffer.h"
+#include "spsc.h"
+
+//  :      ,   
+enum CommandType {
+    CMD_MOVE_CURSOR, // dx, dy -    
+    CMD_BUILD,
+    CMD_SELL,
+    CMD_CYCLE_POLICY,
+    CMD_CYCLE_TOWER,
+    CMD_PAUSE,
+    CMD_SPEED,
+    CMD_QUIT
 };
 
-class BasicTower : public Tower {
-public:
-    BasicTower(int x, int y);
-};
-
-class SplashTower : public Tower {
-public:
-    SplashTower(int x, int y);
-    void attack(Enemy& enemy);
-};
-
-class Enemy {
-protected:
-    int x, y;
-    int health;
-    int speed;
-    int reward;
-
-public:
-    Enemy(int startX, int startY, int hp, int spd, int rwd);
-    void move(const Map& map);
-    void takeDamage(int dmg);
-    bool isAlive() const;
-    int getX() const;
-    int getY() const;
-    int getReward() const;
-    size_t currentPathIndex = 0;
-    float progress = 0.0f;
+struct Command {
+    CommandType type;
+    int dx, dy;
 };
 
-class TankEnemy : public Enemy {
-public:
-    TankEnemy(int startX, int startY);
-};
-
-class Player {
-private:
-    int money;
-    int health;
-
-public:
-    Player();
-    bool isAlive() const;
-    bool canAfford(int amount) const;
-    void spendMoney(int amount);
-    void takeDamage(int damage);
-    void addMoney(int amount);
-    int getHealth() const { return health; }
-    int getMoney() const { return money; }
-};
-
-class WaveManager {
-public:
-    void spawnWave(std::vector<Enemy*>& enemies, int waveNumber);
+// ,       .   ,
+//    .  Map    ,   
+//  : ,    
+struct RenderSnapshot {
+    struct Sprite {
+        int x, y;
+        char symbol;
+    };
+    std::vector<Sprite> towers;
+    std::vector<std::pair<int, int>> enemies;     //   
+    std::vector<std::pair<int, int>> projectiles;
+    int cursorX = 0, cursorY = 0;
+    int overlayRange = -1; //    , -1 -  
+    int coverage = 0;      //     
+    bool towerUnderCursor = false;
+    int sellPrice = 0;
+    TargetPolicy policy = TARGET_FIRST;
+    int wave = 0, money = 0, health = 0;
+    bool paused = false;
+    int gameSpeed = 1;
+    TowerType selectedTower = TOWER_BASIC;
+    bool flash = false;    //     
+    std::string message;   //     
+    bool gameOver = false;
 };
 
 class Game {
 private:
-    Map map;
-    Player player;
-    WaveManager waveManager;
-    std::vector<Tower*> towers;
-    std::vector<Enemy*> enemies;
-    int currentWave;
+    typedef std::chrono::steady_clock clock;
+
+    JobSystem jobs; //   sim:      
+    Simulation sim;
     bool paused;
-    std::chrono::steady_clock::time_point lastEnemyMoveTime;
-    clock_t lastWaveSpawnTime;
-    int gameSpeed;
-
-    bool enemyReachedBase(const Enemy& enemy) const;
-    Tower* getTowerAt(int x, int y) const {
-        for (auto tower : towers) {
-            if (tower->getX() == x && tower->getY() == y) {
-                return tower;
-            }
-        }
-        return nullptr;
-    }
-    void flash() {
-        attron(A_REVERSE);
-        mvaddch(cursorY, cursorX, ' ');
-        refresh();
-        napms(100);
-        attroff(A_REVERSE);
+    int gameSpeed; //  : 1, 2, 4  0 ()
+    TowerType selectedTower; //     T
+    std::string message;
+    clock::time_point messageUntil;
+    clock::time_point flashUntil;
+
+    //    ncurses ,  getch:    
+    //         
+    TripleBuffer<RenderSnapshot> snapshots;
+    SpscQueue<Command, 256> commands;
+
+    //   .  (  )     
+    // pad, HUD -    ,    doupdate
+    static const int HUD_ROWS = 4;
+    static constexpr int MINIMAP_WIDTH = 32;
+    WINDOW* terrainPad;
+    WINDOW* mapWin;
+    WINDOW* hudWin;
+    WINDOW* minimapWin; // nullptr,      
+    std::string hudLines[HUD_ROWS]; //  HUD:  ,    
+
+    // :    [camX, camX + viewW) x [camY, camY + viewH)   
+    int camX, camY;
+    int viewW, viewH;
+
+    // :   -  blockW x blockH  
+    int minimapW, minimapH;
+    int blockW, blockH;
+    std::vector<uint8_t> minimapPath;  //     ,   
+    std::vector<uint8_t> minimapMarks; //        
+
+    //      .    ,   
+    //  ,     
+    std::vector<chtype> frame;   //   ,     
+    std::vector<chtype> screen;  //      
+    std::vector<uint32_t> touched;     // ,      
+    std::vector<uint32_t> prevTouched; //   :     
+
+    void flash() { flashUntil = clock::now() + std::chrono::milliseconds(100); }
+    void showMessage(const std::string& text) {
+        message = text;
+        messageUntil = clock::now() + std::chrono::seconds(1);
     }
+    void publish(float alpha);
+    void renderLoop();
+    void initLayers();
+    void closeLayers();
+    chtype terrainAt(int x, int y) const { return mvwinch(terrainPad, y, x); }
+    void followCursor(int x, int y);
+    void resetView();
+    void put(int x, int y, chtype ch);
+    void drawMinimap(const RenderSnapshot& s);
+    void readInput();
+    void applyCommands();
 
 public:
 
-    Game();
+    //      :      
+    Game(int width = 150, int height = 55, int level = DEFAULT_LEVEL);
     void run();
-    void handleInput();
+    void handleCommand(const Command& cmd);
     void togglePause() { paused = !paused; }
-    void moveEnemies();
-    void update();
-    void render();
+    void cycleSpeed();
+    void render(const RenderSnapshot& s);
     int cursorX;
     int cursorY;
-    void updateProjectiles();
-    std::vector<Projectile> projectiles;
-    const float projectileSpeed = 0.1f; 
-    ~Game();
 
 };
 
-#endif // KAKA_H
\ No newline at end of file
+#endif // KAKA_H
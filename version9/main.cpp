@@ -1,7 +1,40 @@
 #include <ncurses.h>
 #include "kaka.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+//     : tower_defense --width 1000 --height 1000 --level 3
+static void usage(const char* prog) {
+    std::fprintf(stderr, "Usage: %s [--width N] [--height N] [--level N]\n", prog);
+}
+
+int main(int argc, char** argv) {
+    int width = 150;
+    int height = 55;
+    int level = DEFAULT_LEVEL;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (std::strcmp(argv[i], "--width") == 0) {
+            width = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--height") == 0) {
+            height = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--level") == 0) {
+            level = std::atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (level < 0 || level > 3 || width < 3 || height < 3) {
+        usage(argv[0]);
+        return 1;
+    }
 
-int main() {
     initscr();
     cbreak();
     noecho();
@@ -12,7 +45,7 @@ int main() {
         start_color();
     }
     
-    Game game;
+    Game game(width, height, level);
     game.run();
     
     endwin();
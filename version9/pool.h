@@ -0,0 +1,85 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+struct PoolStats {
+    size_t capacity = 0;
+    size_t used = 0;
+    size_t peak = 0;   //     
+    size_t failed = 0; //  - 
+};
+
+//    :     ,    .
+template <class T>
+class Pool {
+private:
+    struct alignas(T) Slot {
+        unsigned char bytes[sizeof(T)];
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeList;
+    std::vector<uint8_t> live;
+    PoolStats stats;
+
+public:
+    explicit Pool(size_t capacity) : slots(capacity), live(capacity, 0) {
+        //    
+        freeList.reserve(capacity);
+        for (size_t i = capacity; i > 0; i--) {
+            freeList.push_back(static_cast<uint32_t>(i - 1));
+        }
+        stats.capacity = capacity;
+    }
+
+    ~Pool() {
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (live[i]) {
+                get(i)->~T();
+            }
+        }
+    }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    //  nullptr,   
+    template <class... Args>
+    T* create(Args&&... args) {
+        if (freeList.empty()) {
+            stats.failed++;
+            return nullptr;
+        }
+        uint32_t i = freeList.back();
+        freeList.pop_back();
+        T* obj = new (slots[i].bytes) T(std::forward<Args>(args)...);
+        live[i] = 1;
+        stats.used++;
+        if (stats.used > stats.peak) stats.peak = stats.used;
+        return obj;
+    }
+
+    void destroy(T* obj) {
+        size_t i = indexOf(obj);
+        obj->~T();
+        live[i] = 0;
+        freeList.push_back(static_cast<uint32_t>(i));
+        stats.used--;
+    }
+
+    //   : ,   
+    size_t indexOf(const T* obj) const {
+        return reinterpret_cast<const Slot*>(obj) - slots.data();
+    }
+
+    T* get(size_t i) { return std::launder(reinterpret_cast<T*>(slots[i].bytes)); }
+    const T* get(size_t i) const { return std::launder(reinterpret_cast<const T*>(slots[i].bytes)); }
+    const PoolStats& getStats() const { return stats; }
+};
+
+#endif // POOL_H
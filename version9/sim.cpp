@@ -0,0 +1,658 @@
+#include "sim.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+
+// Map implementation
+Map::Map(int w, int h, int lvl) : width(w), height(h), level(lvl), pathLength(0.0f) {
+    size_t words = (static_cast<size_t>(width) * height + 63) / 64;
+    pathBits.assign(words, 0);
+    towerBits.assign(words, 0);
+    towerIds.assign(static_cast<size_t>(width) * height, NO_TOWER);
+    generatePath();
+}
+
+void Map::generatePath() {
+    path.clear();
+    const int roadWidth = 3;
+
+    switch (level) {
+    case 1: {
+        //    3 
+        for (int x = 0; x < width; x++) {
+            for (int dy = -(roadWidth / 2); dy <= roadWidth / 2; dy++) {
+                int y = height/2 + dy;
+                if(y >= 0 && y < height) {
+                    path.push_back({x, y});
+                    markPath(x, y);
+                }
+            }
+        }
+        break;
+    }
+    case 2: {
+        //  2: 
+        bool goingDown = true;
+        int y = height / 3;
+
+        for (int x = 0; x < width; x++) {
+            path.push_back({x, y});
+            markPath(x, y);
+
+            if (x % 5 == 0) {
+                y += goingDown ? 1 : -1;
+                if (y <= 1 || y >= height - 2) goingDown = !goingDown;
+            }
+        }
+        break;
+    }
+    case 3: {
+        //  3:      .     
+        //  gap ,      ,   
+        const int gap = 4;
+        int x = width / 2, y = height / 2;
+        int dx = 1, dy = 0;
+        int steps = gap;
+        int stepCount = 0;
+        int dirChanges = 0;
+
+        while (x >= 0 && x < width && y >= 0 && y < height) {
+            path.push_back({x, y});
+
+            x += dx;
+            y += dy;
+            stepCount++;
+
+            if (stepCount == steps) {
+                stepCount = 0;
+                //  
+                int temp = dx;
+                dx = -dy;
+                dy = temp;
+                dirChanges++;
+
+                if (dirChanges % 2 == 0) {
+                    steps += gap;
+                }
+            }
+        }
+        std::reverse(path.begin(), path.end());
+        for (const auto& point : path) {
+            markPath(point.first, point.second);
+        }
+        break;
+    }
+    default:
+        //   :  
+        for (int x = 0; x < width; x++) {
+            path.push_back({x, height / 2});
+            markPath(x, height / 2);
+        }
+        break;
+    }
+
+    buildArcTable();
+}
+
+void Map::buildArcTable() {
+    pathX.resize(path.size());
+    pathY.resize(path.size());
+    for (size_t i = 0; i < path.size(); i++) {
+        pathX[i] = path[i].first;
+        pathY[i] = path[i].second;
+    }
+
+    //      
+    std::vector<float> pathArc(path.size(), 0.0f);
+    for (size_t i = 1; i < path.size(); i++) {
+        float dx = static_cast<float>(path[i].first - path[i - 1].first);
+        float dy = static_cast<float>(path[i].second - path[i - 1].second);
+        pathArc[i] = pathArc[i - 1] + std::sqrt(dx * dx + dy * dy);
+    }
+    pathLength = path.empty() ? 0.0f : pathArc.back();
+
+    //    1/ARC_SAMPLES_PER_CELL -   
+    size_t samples = static_cast<size_t>(pathLength * ARC_SAMPLES_PER_CELL) + 1;
+    arcNode.assign(samples, 0);
+    size_t segment = 0;
+    for (size_t k = 0; k < samples; k++) {
+        float d = static_cast<float>(k) / ARC_SAMPLES_PER_CELL;
+        while (segment + 2 < path.size() && pathArc[segment + 1] <= d) {
+            segment++;
+        }
+        if (segment + 1 < path.size() && d - pathArc[segment] >= 0.5f * (pathArc[segment + 1] - pathArc[segment])) {
+            arcNode[k] = static_cast<uint32_t>(segment + 1);
+        } else {
+            arcNode[k] = static_cast<uint32_t>(segment);
+        }
+    }
+    //       
+    if (!path.empty()) {
+        arcNode.back() = static_cast<uint32_t>(path.size() - 1);
+    }
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> Map::pathWindows(int x, int y, int range) const {
+    std::vector<std::pair<uint32_t, uint32_t>> windows;
+    const size_t CHUNK = 256;
+    uint64_t mask[CHUNK / 64];
+    for (size_t start = 0; start < path.size(); start += CHUNK) {
+        size_t n = std::min(CHUNK, path.size() - start);
+        if (rangeMask(x, y, range, &pathX[start], &pathY[start], n, mask) == 0) continue;
+        for (size_t k = 0; k < n; k++) {
+            if (!((mask[k >> 6] >> (k & 63)) & 1)) continue;
+            uint32_t node = static_cast<uint32_t>(start + k);
+            //      
+            if (!windows.empty() && windows.back().second + 1 == node) {
+                windows.back().second = node;
+            } else {
+                windows.push_back({node, node});
+            }
+        }
+    }
+    return windows;
+}
+
+int Map::pathCellsInRange(int x, int y, int range) const {
+    int count = 0;
+    forEachDiskSpan(x, y, range, width, height, [&](int row, int x0, int x1) {
+        //   -    [first, last]
+        size_t first = index(x0, row);
+        size_t last = index(x1, row);
+        for (size_t w = first >> 6; w <= last >> 6; w++) {
+            uint64_t bits = pathBits[w];
+            if (w == first >> 6) bits &= ~uint64_t(0) << (first & 63);
+            if (w == last >> 6) bits &= ~uint64_t(0) >> (63 - (last & 63));
+            count += __builtin_popcountll(bits);
+        }
+    });
+    return count;
+}
+
+const char* Map::getLevelName() const {
+    switch (level) {
+        case 1: return "Straight path";
+        case 2: return "Zigzag";
+        case 3: return "Spiral";
+        default: return "Default";
+    }
+}
+
+void Map::markPath(int x, int y) {
+    if (!inBounds(x, y)) return;
+    setBit(pathBits, index(x, y));
+}
+
+bool Map::canPlaceTower(int x, int y) const {
+    if (!inBounds(x, y)) return false;
+    size_t i = index(x, y);
+    //     :  ,      
+    return !((pathBits[i >> 6] | towerBits[i >> 6]) >> (i & 63) & 1);
+}
+
+void Map::placeTower(int x, int y, int32_t towerId) {
+    if (canPlaceTower(x, y)) {
+        setBit(towerBits, index(x, y));
+        towerIds[index(x, y)] = towerId;
+    }
+}
+
+void Map::removeTower(int x, int y) {
+    if (hasTower(x, y)) {
+        clearBit(towerBits, index(x, y));
+        towerIds[index(x, y)] = NO_TOWER;
+    }
+}
+
+// Tower implementations
+Tower::Tower(int x, int y, TowerType t) : x(x), y(y), type(t) {}
+
+// EnemyStore implementation
+void EnemyStore::reserve(size_t capacity) {
+    x.reserve(capacity);
+    y.reserve(capacity);
+    distance.reserve(capacity);
+    prevDistance.reserve(capacity);
+    node.reserve(capacity);
+    health.reserve(capacity);
+    speed.reserve(capacity);
+    reward.reserve(capacity);
+    type.reserve(capacity);
+    leaked.reserve(capacity);
+    slot.reserve(capacity);
+    slotIndex.reserve(capacity);
+    slotGeneration.reserve(capacity);
+    freeSlots.reserve(capacity);
+    poolStats.capacity = capacity;
+}
+
+size_t EnemyStore::add(EnemyType t, int startX, int startY) {
+    if (size() >= poolStats.capacity) {
+        poolStats.failed++;
+        return NO_ENEMY;
+    }
+    const EnemyArchetype& a = ENEMY_ARCHETYPES[t];
+    x.push_back(startX);
+    y.push_back(startY);
+    distance.push_back(0.0f);
+    prevDistance.push_back(0.0f);
+    node.push_back(0);
+    health.push_back(a.health);
+    speed.push_back(a.speed);
+    reward.push_back(a.reward);
+    type.push_back(static_cast<uint8_t>(t));
+    leaked.push_back(0);
+
+    uint32_t s;
+    if (!freeSlots.empty()) {
+        s = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        s = static_cast<uint32_t>(slotIndex.size());
+        slotIndex.push_back(0);
+        slotGeneration.push_back(0);
+    }
+    slotIndex[s] = static_cast<uint32_t>(size() - 1);
+    slot.push_back(s);
+
+    poolStats.used = size();
+    poolStats.peak = std::max(poolStats.peak, poolStats.used);
+    return size() - 1;
+}
+
+void EnemyStore::moveEntry(size_t dst, size_t src) {
+    x[dst] = x[src];
+    y[dst] = y[src];
+    distance[dst] = distance[src];
+    prevDistance[dst] = prevDistance[src];
+    node[dst] = node[src];
+    health[dst] = health[src];
+    speed[dst] = speed[src];
+    reward[dst] = reward[src];
+    type[dst] = type[src];
+    leaked[dst] = leaked[src];
+    slot[dst] = slot[src];
+    slotIndex[slot[dst]] = static_cast<uint32_t>(dst);
+}
+
+void EnemyStore::swapEntries(size_t a, size_t b) {
+    std::swap(x[a], x[b]);
+    std::swap(y[a], y[b]);
+    std::swap(distance[a], distance[b]);
+    std::swap(prevDistance[a], prevDistance[b]);
+    std::swap(node[a], node[b]);
+    std::swap(health[a], health[b]);
+    std::swap(speed[a], speed[b]);
+    std::swap(reward[a], reward[b]);
+    std::swap(type[a], type[b]);
+    std::swap(leaked[a], leaked[b]);
+    std::swap(slot[a], slot[b]);
+    slotIndex[slot[a]] = static_cast<uint32_t>(a);
+    slotIndex[slot[b]] = static_cast<uint32_t>(b);
+}
+
+void EnemyStore::sortByDistance() {
+    //  :        ,   
+    const size_t n = size();
+    for (size_t i = 1; i < n; i++) {
+        for (size_t j = i; j > 0 && distance[j - 1] < distance[j]; j--) {
+            swapEntries(j - 1, j);
+        }
+    }
+}
+
+std::pair<size_t, size_t> EnemyStore::nodeRange(uint32_t first, uint32_t last) const {
+    // node    
+    auto begin = std::lower_bound(node.begin(), node.end(), last, std::greater<uint32_t>());
+    auto end = std::upper_bound(begin, node.end(), first, std::greater<uint32_t>());
+    return {static_cast<size_t>(begin - node.begin()), static_cast<size_t>(end - node.begin())};
+}
+
+void EnemyStore::resize(size_t n) {
+    x.resize(n);
+    y.resize(n);
+    distance.resize(n);
+    prevDistance.resize(n);
+    node.resize(n);
+    health.resize(n);
+    speed.resize(n);
+    reward.resize(n);
+    type.resize(n);
+    leaked.resize(n);
+    slot.resize(n);
+    poolStats.used = n;
+}
+
+// Player implementation
+Player::Player() : money(100), health(100) {}
+
+bool Player::isAlive() const { return health > 0; }
+bool Player::canAfford(int amount) const { return money >= amount; }
+void Player::spendMoney(int amount) { money -= amount; }
+void Player::takeDamage(int damage) { health -= damage; }
+void Player::addMoney(int amount) { money += amount; }
+
+// WaveManager implementation
+void WaveManager::spawnWave(EnemyStore& enemies, const Map& map, int waveNumber, Rng& rng) {
+    //     
+    const auto& start = map.getPath().front();
+    int numEnemies = 5 + waveNumber * 2;
+    for (int i = 0; i < numEnemies; i++) {
+        if (rng.nextBelow(2) == 0) {
+            enemies.add(ENEMY_BASIC, start.first, start.second);
+        } else {
+            enemies.add(ENEMY_TANK, start.first, start.second);
+        }
+    }
+}
+
+// Simulation implementation
+Simulation::Simulation(int w, int h, int level, uint64_t seed, JobSystem* sharedJobs) :
+    map(w, h, level), rng(seed), towerPool(MAX_TOWERS),
+    enemyGrid(w, h, SPATIAL_CELL_SIZE), enemyGridDirty(true), currentWave(0), tickCount(0),
+    localJobs(1), jobs(sharedJobs != nullptr ? *sharedJobs : localJobs) {
+    enemies.reserve(MAX_ENEMIES);
+}
+
+bool Simulation::enemyReachedBase(size_t i) const {
+    return enemies.distance[i] >= map.getPathLength();
+}
+
+bool Simulation::buildTower(int x, int y, TowerType type) {
+    const TowerArchetype& archetype = TOWER_ARCHETYPES[type];
+    if (getTowerAt(x, y) != nullptr || !map.canPlaceTower(x, y)) return false;
+    if (!player.canAfford(archetype.cost)) return false;
+
+    Tower* tower = towerPool.create(x, y, type);
+    if (tower == nullptr) return false;
+
+    tower->pathWindows = map.pathWindows(x, y, archetype.range);
+    towers.push_back(tower);
+    towerGroups[archetype.attack].push_back(tower);
+    map.placeTower(x, y, static_cast<int32_t>(towerPool.indexOf(tower)));
+    player.spendMoney(archetype.cost);
+    stats.towersBuilt++;
+    return true;
+}
+
+bool Simulation::setTowerPolicy(int x, int y, TargetPolicy policy) {
+    Tower* tower = getTowerAt(x, y);
+    if (tower == nullptr) return false;
+    tower->policy = policy;
+    return true;
+}
+
+int Simulation::sellTower(int x, int y) {
+    Tower* tower = getTowerAt(x, y);
+    if (tower == nullptr) return -1;
+
+    int refund = tower->getCost() / 2;
+    player.addMoney(refund);
+    map.removeTower(x, y);
+    towers.erase(std::remove(towers.begin(), towers.end(), tower), towers.end());
+    auto& group = towerGroups[tower->getArchetype().attack];
+    group.erase(std::remove(group.begin(), group.end(), tower), group.end());
+    towerPool.destroy(tower);
+    return refund;
+}
+
+void Simulation::moveEnemies() {
+    const auto& path = map.getPath();
+    const float length = map.getPathLength();
+
+    //  -  ,  -     .
+    //  ;    ,    
+    const size_t n = enemies.size();
+    baseDamageBuffers.assign(JobSystem::chunkCount(n, ENEMY_GRAIN), 0);
+    jobs.parallelFor(n, ENEMY_GRAIN, [&](size_t chunk, size_t begin, size_t end) {
+        int baseDamage = 0;
+        for (size_t i = begin; i < end; i++) {
+            if (enemies.leaked[i]) continue;
+
+            float d = std::min(enemies.distance[i] + ENEMY_SPEED_SCALE * enemies.speed[i], length);
+            uint32_t node = map.nodeAt(d);
+            enemies.distance[i] = d;
+            enemies.node[i] = node;
+            enemies.x[i] = path[node].first;
+            enemies.y[i] = path[node].second;
+
+            if (enemyReachedBase(i)) {
+                //          
+                baseDamage += 10;
+                enemies.leaked[i] = 1;
+            }
+        }
+        baseDamageBuffers[chunk] = baseDamage;
+    });
+
+    for (int damage : baseDamageBuffers) {
+        if (damage > 0) player.takeDamage(damage);
+    }
+}
+
+void Simulation::update() {
+    //  : , , ,  , .
+    // ,       ,  -  
+
+    //   
+    if (enemies.empty()) {
+        currentWave++;
+        stats.goldAtWave.push_back(player.getMoney());
+        waveManager.spawnWave(enemies, map, currentWave, rng);
+    }
+
+    enemies.prevDistance = enemies.distance;
+
+    //  
+    moveEnemies();
+    enemies.sortByDistance();
+    enemyGridDirty = true;
+
+    if (towerGroups[ATTACK_SPLASH].empty()) {
+        //  
+        fireAllTowers();
+
+        //    
+        updateProjectiles();
+    } else {
+        //      ,   -   :
+        //          
+        JobSystem::TaskRef grid = jobs.create([this]() { getEnemyGrid(); });
+        JobSystem::TaskRef fire = jobs.create([this]() { fireAllTowers(); });
+        JobSystem::TaskRef resolve = jobs.create([this]() { updateProjectiles(); }, {grid, fire});
+        jobs.submit(grid);
+        jobs.submit(fire);
+        jobs.submit(resolve);
+        jobs.wait(resolve);
+    }
+
+    //   
+    enemies.removeIf([this](size_t i) {
+        if (!enemies.isAlive(i)) {
+            player.addMoney(enemies.reward[i]);
+            stats.kills++;
+            return true;
+        }
+        if (enemies.leaked[i]) {
+            stats.leaks++;
+            return true;
+        }
+        return false;
+    });
+
+    tickCount++;
+}
+
+const SpatialGrid& Simulation::getEnemyGrid() {
+    if (enemyGridDirty) {
+        enemyGrid.rebuild(enemies);
+        enemyGridDirty = false;
+    }
+    return enemyGrid;
+}
+
+uint32_t Simulation::selectTarget(const Tower& tower) const {
+    //    -     ,  .    
+    //  ,     -  ,  ""  "" 
+    //        
+    const auto& windows = tower.pathWindows;
+    switch (tower.policy) {
+        case TARGET_FIRST:
+            for (size_t w = windows.size(); w > 0; w--) {
+                auto range = enemies.nodeRange(windows[w - 1].first, windows[w - 1].second);
+                for (size_t i = range.first; i < range.second; i++) {
+                    if (enemies.isAlive(i) && !enemies.leaked[i]) return static_cast<uint32_t>(i);
+                }
+            }
+            return NO_ENEMY;
+
+        case TARGET_LAST:
+            for (const auto& window : windows) {
+                auto range = enemies.nodeRange(window.first, window.second);
+                for (size_t i = range.second; i > range.first; i--) {
+                    if (enemies.isAlive(i - 1) && !enemies.leaked[i - 1]) return static_cast<uint32_t>(i - 1);
+                }
+            }
+            return NO_ENEMY;
+
+        case TARGET_STRONGEST:
+        case TARGET_CLOSEST: {
+            uint32_t best = NO_ENEMY;
+            long long bestScore = 0;
+            for (const auto& window : windows) {
+                auto range = enemies.nodeRange(window.first, window.second);
+                for (size_t i = range.first; i < range.second; i++) {
+                    if (!enemies.isAlive(i) || enemies.leaked[i]) continue;
+                    long long score;
+                    if (tower.policy == TARGET_STRONGEST) {
+                        score = enemies.health[i];
+                    } else {
+                        long long dx = enemies.x[i] - tower.getX();
+                        long long dy = enemies.y[i] - tower.getY();
+                        score = -(dx * dx + dy * dy);
+                    }
+                    if (best == NO_ENEMY || score > bestScore) {
+                        best = static_cast<uint32_t>(i);
+                        bestScore = score;
+                    }
+                }
+            }
+            return best;
+        }
+
+        default:
+            return NO_ENEMY;
+    }
+}
+
+template <AttackKind Kind>
+void Simulation::fireTowers() {
+    std::vector<Tower*>& group = towerGroups[Kind];
+    //        .    ,
+    //           
+    const size_t chunks = JobSystem::chunkCount(group.size(), TOWER_GRAIN);
+    if (shotBuffers.size() < chunks) shotBuffers.resize(chunks);
+    jobs.parallelFor(group.size(), TOWER_GRAIN, [&](size_t chunk, size_t begin, size_t end) {
+        std::vector<Projectile>& shots = shotBuffers[chunk];
+        shots.clear();
+        for (size_t t = begin; t < end; t++) {
+            Tower* tower = group[t];
+            if (tower->cooldown > 0) {
+                tower->cooldown--;
+                continue;
+            }
+            uint32_t target = selectTarget(*tower);
+            if (target == NO_ENEMY) continue;
+
+            const TowerArchetype& a = tower->getArchetype();
+            if (Kind == ATTACK_SPLASH) {
+                shots.emplace_back(tower->getX(), tower->getY(), enemies.handleOf(target),
+                                   enemies.x[target], enemies.y[target], a.damage, a.splashRadius);
+            } else {
+                shots.emplace_back(tower->getX(), tower->getY(), enemies.handleOf(target),
+                                   enemies.x[target], enemies.y[target], a.damage);
+            }
+            tower->cooldown = a.reload - 1;
+        }
+    });
+
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        projectiles.insert(projectiles.end(), shotBuffers[chunk].begin(), shotBuffers[chunk].end());
+    }
+}
+
+void Simulation::fireAllTowers() {
+    static_assert(ATTACK_KIND_COUNT == 2, "fireAllTowers must fire every AttackKind");
+    fireTowers<ATTACK_PROJECTILE>();
+    fireTowers<ATTACK_SPLASH>();
+}
+
+void Simulation::applySplash(int x, int y, int radius, int damage) {
+    //      ,    
+    getEnemyGrid().forEachInRadius(x, y, radius, [&](uint32_t i) {
+        if (enemies.isAlive(i)) {
+            enemies.takeDamage(i, damage);
+        }
+    });
+}
+
+void Simulation::updateProjectiles() {
+    //   :        
+    const size_t n = projectiles.size();
+    const size_t chunks = JobSystem::chunkCount(n, PROJECTILE_GRAIN);
+    if (hitBuffers.size() < chunks) hitBuffers.resize(chunks);
+    projectileDone.assign(n, 0);
+    jobs.parallelFor(n, PROJECTILE_GRAIN, [&](size_t chunk, size_t begin, size_t end) {
+        std::vector<ProjectileHit>& hits = hitBuffers[chunk];
+        hits.clear();
+        for (size_t i = begin; i < end; i++) {
+            Projectile& p = projectiles[i];
+            //  
+            p.progress += projectileSpeed;
+            uint32_t target = enemies.indexOf(p.target);
+            if (target != NO_ENEMY && !enemies.isAlive(target)) target = NO_ENEMY;
+            if (target == NO_ENEMY && p.splashRadius == 0) {
+                projectileDone[i] = 1; //   -  
+                continue;
+            }
+            //            
+            if (target != NO_ENEMY) {
+                p.impactX = enemies.x[target];
+                p.impactY = enemies.y[target];
+            }
+
+            //   
+            int dx = p.impactX - p.startX;
+            int dy = p.impactY - p.startY;
+            p.currentX = p.startX + static_cast<int>(dx * p.progress);
+            p.currentY = p.startY + static_cast<int>(dy * p.progress);
+
+            //   
+            if (p.progress >= 1.0f) {
+                hits.push_back({target, p.impactX, p.impactY, p.damage, p.splashRadius});
+                projectileDone[i] = 1;
+            }
+        }
+    });
+
+    //     : ,     ,    .
+    //         ,     
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        for (const ProjectileHit& hit : hitBuffers[chunk]) {
+            if (hit.splashRadius > 0) {
+                applySplash(hit.x, hit.y, hit.splashRadius, hit.damage);
+            } else if (enemies.isAlive(hit.target)) {
+                enemies.takeDamage(hit.target, hit.damage);
+            }
+        }
+    }
+
+    size_t out = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (projectileDone[i]) continue;
+        if (out != i) projectiles[out] = projectiles[i];
+        out++;
+    }
+    projectiles.erase(projectiles.begin() + out, projectiles.end());
+}
@@ -0,0 +1,421 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "pool.h"
+#include "spatial.h"
+#include "stencil.h"
+#include "jobs.h"
+
+//    ncurses:    ,  td_sim
+typedef struct _win_st WINDOW;
+
+#if defined(LEVEL_1)
+#define DEFAULT_LEVEL 1
+#elif defined(LEVEL_2)
+#define DEFAULT_LEVEL 2
+#elif defined(LEVEL_3)
+#define DEFAULT_LEVEL 3
+#else
+#define DEFAULT_LEVEL 0
+#endif
+
+//    PCG32:    ,   seed
+class Rng {
+private:
+    uint64_t state;
+    uint64_t inc;
+
+public:
+    explicit Rng(uint64_t seed, uint64_t stream = 0x14057b7ef767814fULL) : state(0), inc((stream << 1) | 1) {
+        next();
+        state += seed;
+        next();
+    }
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rot = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+    //   [0, bound),    
+    uint32_t nextBelow(uint32_t bound) {
+        uint64_t m = static_cast<uint64_t>(next()) * bound;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < bound) {
+            uint32_t threshold = -bound % bound;
+            while (low < threshold) {
+                m = static_cast<uint64_t>(next()) * bound;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+};
+
+//    EnemyStore,   
+const uint32_t NO_ENEMY = UINT32_MAX;
+
+//   :     .
+//      ,     
+struct EnemyHandle {
+    uint32_t slot = NO_ENEMY;
+    uint32_t generation = 0;
+};
+
+struct Projectile {
+    int startX, startY;   //  
+    int currentX, currentY;//  
+    EnemyHandle target;   // 
+    int impactX, impactY; //    :       
+    float progress;        //   (0.0 - 1.0)
+    int damage;            // 
+    int splashRadius;      //      , 0 -  
+
+    Projectile(int sx, int sy, EnemyHandle t, int tx, int ty, int dmg, int splash = 0)
+        : startX(sx), startY(sy), target(t), impactX(tx), impactY(ty), progress(0.0f), damage(dmg), splashRadius(splash) {
+        currentX = sx;
+        currentY = sy;
+    }
+};
+
+// :             
+class Map {
+private:
+    int width, height;
+    int level;
+    std::vector<uint64_t> pathBits;   //  
+    std::vector<uint64_t> towerBits;  //   
+    std::vector<int32_t> towerIds;    // width * height, :      NO_TOWER
+    std::vector<std::pair<int, int>> path;
+    std::vector<int> pathX, pathY;   //     ,    
+    std::vector<uint32_t> arcNode;   //      k / ARC_SAMPLES_PER_CELL
+    float pathLength;
+
+    size_t index(int x, int y) const { return static_cast<size_t>(y) * width + x; }
+    static bool testBit(const std::vector<uint64_t>& bits, size_t i) { return (bits[i >> 6] >> (i & 63)) & 1; }
+    static void setBit(std::vector<uint64_t>& bits, size_t i) { bits[i >> 6] |= uint64_t(1) << (i & 63); }
+    static void clearBit(std::vector<uint64_t>& bits, size_t i) { bits[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+    void markPath(int x, int y);
+    void buildArcTable();
+
+public:
+    static constexpr int32_t NO_TOWER = -1;
+    static constexpr int ARC_SAMPLES_PER_CELL = 8;
+
+    Map(int w, int h, int lvl = DEFAULT_LEVEL);
+    void generatePath();
+    void draw(WINDOW* win) const; //   kaka.cpp
+    bool inBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+    bool isPath(int x, int y) const { return inBounds(x, y) && testBit(pathBits, index(x, y)); }
+    bool hasTower(int x, int y) const { return inBounds(x, y) && testBit(towerBits, index(x, y)); }
+    bool canPlaceTower(int x, int y) const;
+    void placeTower(int x, int y, int32_t towerId);
+    void removeTower(int x, int y);
+    int32_t towerAt(int x, int y) const { return inBounds(x, y) ? towerIds[index(x, y)] : NO_TOWER; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const char* getLevelName() const;
+    const std::vector<std::pair<int, int>>& getPath() const { return path; }
+    float getPathLength() const { return pathLength; }
+    //    [first, second],    (x, y)   range
+    std::vector<std::pair<uint32_t, uint32_t>> pathWindows(int x, int y, int range) const;
+    //      range:      
+    int pathCellsInRange(int x, int y, int range) const;
+    // fn(cx, cy)       range  (x, y)
+    template <class Fn>
+    void forEachCellInRange(int x, int y, int range, Fn fn) const {
+        forEachDiskCell(x, y, range, width, height, fn);
+    }
+    //  ,    ,   d:    
+    uint32_t nodeAt(float d) const {
+        size_t k = d > 0.0f ? static_cast<size_t>(d * ARC_SAMPLES_PER_CELL) : 0;
+        return arcNode[k < arcNode.size() ? k : arcNode.size() - 1];
+    }
+};
+
+enum TowerType {
+    TOWER_BASIC,
+    TOWER_SPLASH,
+    TOWER_TYPE_COUNT
+};
+
+//  :         
+enum AttackKind {
+    ATTACK_PROJECTILE, //     
+    ATTACK_SPLASH,     // ,       splashRadius
+    ATTACK_KIND_COUNT
+};
+
+//       
+enum TargetPolicy {
+    TARGET_FIRST,     //     
+    TARGET_LAST,      //   
+    TARGET_STRONGEST, //   
+    TARGET_CLOSEST,   //   
+    TARGET_POLICY_COUNT
+};
+
+const char* const TARGET_POLICY_NAMES[TARGET_POLICY_COUNT] = {"first", "last", "strongest", "closest"};
+
+struct TowerArchetype {
+    const char* name;
+    char symbol;
+    int damage;
+    int range;
+    int cost;
+    int reload; //   
+    AttackKind attack;
+    int splashRadius; //  ATTACK_SPLASH
+};
+
+//    ,  - TowerType.   -   
+constexpr TowerArchetype TOWER_ARCHETYPES[TOWER_TYPE_COUNT] = {
+    {"Basic", 'T', 10, 10, 30, 1, ATTACK_PROJECTILE, 0},  // TOWER_BASIC
+    {"Splash", 'S', 15, 3, 50, 1, ATTACK_SPLASH, 2},      // TOWER_SPLASH
+};
+
+constexpr bool archetypesFitStencils() {
+    for (const TowerArchetype& a : TOWER_ARCHETYPES) {
+        if (a.range > MAX_STENCIL_RADIUS || a.splashRadius > MAX_STENCIL_RADIUS) return false;
+    }
+    return true;
+}
+static_assert(archetypesFitStencils(), "tower range exceeds MAX_STENCIL_RADIUS");
+
+class Tower {
+private:
+    int x, y;
+    TowerType type;
+
+public:
+    int cooldown = 0; //    
+    TargetPolicy policy = TARGET_FIRST;
+    //     ,     
+    std::vector<std::pair<uint32_t, uint32_t>> pathWindows;
+
+    Tower(int x, int y, TowerType t);
+    const TowerArchetype& getArchetype() const { return TOWER_ARCHETYPES[type]; }
+    int getCost() const { return getArchetype().cost; }
+    int getX() const { return x; }
+    int getY() const { return y; }
+};
+
+enum EnemyType {
+    ENEMY_BASIC,
+    ENEMY_TANK
+};
+
+struct EnemyArchetype {
+    int health;
+    int speed;
+    int reward;
+};
+
+//    ,  - EnemyType
+const EnemyArchetype ENEMY_ARCHETYPES[] = {
+    {30, 1, 10},      // ENEMY_BASIC
+    {100000, 1, 30},  // ENEMY_TANK
+};
+
+//    :        
+struct EnemyStore {
+    std::vector<int> x, y;
+    std::vector<float> distance;     //    
+    std::vector<float> prevDistance; //    ,    
+    std::vector<uint32_t> node;      //  ,    
+    std::vector<int> health;
+    std::vector<int> speed;
+    std::vector<int> reward;
+    std::vector<uint8_t> type;
+    std::vector<uint8_t> leaked; //   ,     
+    std::vector<uint32_t> slot;  //     
+
+    //       ,     malloc
+    void reserve(size_t capacity);
+    PoolStats getPoolStats() const { return poolStats; }
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    bool isAlive(size_t i) const { return health[i] > 0; }
+    void takeDamage(size_t i, int dmg) { health[i] -= dmg; }
+    size_t add(EnemyType t, int startX, int startY); // NO_ENEMY,   
+
+    EnemyHandle handleOf(size_t i) const { return {slot[i], slotGeneration[slot[i]]}; }
+    bool isValid(EnemyHandle h) const {
+        return h.slot < slotGeneration.size() && slotGeneration[h.slot] == h.generation;
+    }
+    //     NO_ENEMY,    
+    uint32_t indexOf(EnemyHandle h) const { return isValid(h) ? slotIndex[h.slot] : NO_ENEMY; }
+
+    //     distance:   ,     .
+    //       distance 0,   ,
+    //      sortByDistance.
+    void sortByDistance();
+    //  [begin, end) ,      first  last 
+    std::pair<size_t, size_t> nodeRange(uint32_t first, uint32_t last) const;
+
+    //  ,   pred(i) ,   .
+    //      
+    template <class Pred>
+    void removeIf(Pred pred) {
+        size_t n = size();
+        size_t out = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (pred(i)) {
+                releaseSlot(slot[i]);
+                continue;
+            }
+            if (out != i) moveEntry(out, i);
+            out++;
+        }
+        resize(out);
+    }
+
+private:
+    PoolStats poolStats;
+    std::vector<uint32_t> slotIndex;      //  ->  
+    std::vector<uint32_t> slotGeneration; //  ->  
+    std::vector<uint32_t> freeSlots;
+
+    void releaseSlot(uint32_t s) {
+        slotGeneration[s]++;
+        freeSlots.push_back(s);
+    }
+
+    void moveEntry(size_t dst, size_t src);
+    void swapEntries(size_t a, size_t b);
+    void resize(size_t n);
+};
+
+typedef Pool<Tower> TowerPool;
+
+class Player {
+private:
+    int money;
+    int health;
+
+public:
+    Player();
+    bool isAlive() const;
+    bool canAfford(int amount) const;
+    void spendMoney(int amount);
+    void takeDamage(int damage);
+    void addMoney(int amount);
+    int getHealth() const { return health; }
+    int getMoney() const { return money; }
+};
+
+//     
+struct SimStats {
+    int kills = 0;
+    int leaks = 0;
+    int towersBuilt = 0;
+    std::vector<int> goldAtWave; //      
+};
+
+class WaveManager {
+public:
+    void spawnWave(EnemyStore& enemies, const Map& map, int waveNumber, Rng& rng);
+};
+
+//  ,        
+struct ProjectileHit {
+    uint32_t target; //    NO_ENEMY:        
+    int x, y;        //  
+    int damage;
+    int splashRadius;
+};
+
+class Simulation {
+private:
+    Map map;
+    Player player;
+    WaveManager waveManager;
+    Rng rng;
+    TowerPool towerPool;
+    std::vector<Tower*> towers;
+    std::vector<Tower*> towerGroups[ATTACK_KIND_COUNT]; //    
+    EnemyStore enemies;
+    SpatialGrid enemyGrid; //        
+    bool enemyGridDirty;   //       
+    std::vector<Projectile> projectiles;
+    int currentWave;
+    long long tickCount;
+    SimStats stats;
+
+    //  ,         .
+    //      ,      
+    JobSystem localJobs; //   ,     
+    JobSystem& jobs;
+    std::vector<int> baseDamageBuffers;                  //  ,   
+    std::vector<std::vector<Projectile>> shotBuffers;    //  ,   
+    std::vector<std::vector<ProjectileHit>> hitBuffers;  // ,   
+    std::vector<uint8_t> projectileDone;                 //     
+
+    bool enemyReachedBase(size_t i) const;
+    void moveEnemies();
+    const SpatialGrid& getEnemyGrid();
+    uint32_t selectTarget(const Tower& tower) const;
+    //     : Kind   
+    template <AttackKind Kind>
+    void fireTowers();
+    void fireAllTowers();
+    void applySplash(int x, int y, int radius, int damage);
+
+public:
+    // jobs -     ;       .
+    //  ,    ,   
+    Simulation(int w, int h, int level, uint64_t seed, JobSystem* jobs = nullptr);
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    //   :   update() = TICK_MS  
+    static const int TICK_MS = 50;
+    //         (2.5 /  speed 1)
+    static constexpr float ENEMY_SPEED_SCALE = 0.125f;
+    //      
+    static const int SPATIAL_CELL_SIZE = 8;
+    //  :    ,     
+    static const size_t MAX_TOWERS = 4096;
+    static const size_t MAX_ENEMIES = 65536;
+    //    :  ,        
+    static const size_t ENEMY_GRAIN = 2048;
+    static const size_t TOWER_GRAIN = 32;
+    static const size_t PROJECTILE_GRAIN = 2048;
+
+    void update();
+    void updateProjectiles();
+    bool buildTower(int x, int y, TowerType type = TOWER_BASIC);
+    int sellTower(int x, int y); //    -1
+    bool setTowerPolicy(int x, int y, TargetPolicy policy);
+    Tower* getTowerAt(int x, int y) {
+        int32_t id = map.towerAt(x, y);
+        return id == Map::NO_TOWER ? nullptr : towerPool.get(id);
+    }
+    const Tower* getTowerAt(int x, int y) const {
+        int32_t id = map.towerAt(x, y);
+        return id == Map::NO_TOWER ? nullptr : towerPool.get(id);
+    }
+
+    const Map& getMap() const { return map; }
+    Player& getPlayer() { return player; }
+    const Player& getPlayer() const { return player; }
+    const std::vector<Tower*>& getTowers() const { return towers; }
+    const EnemyStore& getEnemies() const { return enemies; }
+    const std::vector<Projectile>& getProjectiles() const { return projectiles; }
+    int getCurrentWave() const { return currentWave; }
+    long long getTickCount() const { return tickCount; }
+    const SimStats& getStats() const { return stats; }
+    const PoolStats& getTowerPoolStats() const { return towerPool.getStats(); }
+    PoolStats getEnemyPoolStats() const { return enemies.getPoolStats(); }
+    int getThreadCount() const { return jobs.size(); }
+    const float projectileSpeed = 0.1f;
+};
+
+#endif // SIM_H
@@ -0,0 +1,155 @@
+#include "spatial.h"
+#include "sim.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RANGE_MASK_X86 1
+#include <immintrin.h>
+#endif
+
+size_t rangeMaskScalar(int cx, int cy, int range, const int* xs, const int* ys, size_t n, uint64_t* mask) {
+    std::memset(mask, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    const int r2 = range * range;
+    size_t hits = 0;
+    for (size_t i = 0; i < n; i++) {
+        int dx = xs[i] - cx;
+        int dy = ys[i] - cy;
+        if (dx * dx + dy * dy <= r2) {
+            mask[i >> 6] |= uint64_t(1) << (i & 63);
+            hits++;
+        }
+    }
+    return hits;
+}
+
+#ifdef RANGE_MASK_X86
+// SSE2: 4   .  SSE2  32- ,  dx  dy
+//    16   _mm_madd_epi16  dx*dx + dy*dy 
+__attribute__((target("sse2")))
+static size_t rangeMaskSse2(int cx, int cy, int range, const int* xs, const int* ys, size_t n, uint64_t* mask) {
+    std::memset(mask, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    const __m128i vcx = _mm_set1_epi32(cx);
+    const __m128i vcy = _mm_set1_epi32(cy);
+    const __m128i vr2 = _mm_set1_epi32(range * range);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i dx = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(xs + i)), vcx);
+        __m128i dy = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + i)), vcy);
+        __m128i pairs = _mm_packs_epi32(_mm_unpacklo_epi32(dx, dy), _mm_unpackhi_epi32(dx, dy));
+        __m128i d2 = _mm_madd_epi16(pairs, pairs);
+        int outside = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(d2, vr2)));
+        mask[i >> 6] |= uint64_t(~outside & 0xF) << (i & 63);
+    }
+    for (; i < n; i++) {
+        int dx = xs[i] - cx;
+        int dy = ys[i] - cy;
+        if (dx * dx + dy * dy <= range * range) {
+            mask[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+    }
+    size_t hits = 0;
+    for (size_t w = 0; w < (n + 63) / 64; w++) {
+        hits += __builtin_popcountll(mask[w]);
+    }
+    return hits;
+}
+
+// AVX2: 8   
+__attribute__((target("avx2")))
+static size_t rangeMaskAvx2(int cx, int cy, int range, const int* xs, const int* ys, size_t n, uint64_t* mask) {
+    std::memset(mask, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    const __m256i vcx = _mm256_set1_epi32(cx);
+    const __m256i vcy = _mm256_set1_epi32(cy);
+    const __m256i vr2 = _mm256_set1_epi32(range * range);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i dx = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + i)), vcx);
+        __m256i dy = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys + i)), vcy);
+        __m256i d2 = _mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy));
+        int outside = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(d2, vr2)));
+        mask[i >> 6] |= uint64_t(~outside & 0xFF) << (i & 63);
+    }
+    for (; i < n; i++) {
+        int dx = xs[i] - cx;
+        int dy = ys[i] - cy;
+        if (dx * dx + dy * dy <= range * range) {
+            mask[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+    }
+    size_t hits = 0;
+    for (size_t w = 0; w < (n + 63) / 64; w++) {
+        hits += __builtin_popcountll(mask[w]);
+    }
+    return hits;
+}
+#endif
+
+typedef size_t (*RangeMaskFn)(int, int, int, const int*, const int*, size_t, uint64_t*);
+
+struct RangeMaskKernel {
+    RangeMaskFn fn;
+    const char* name;
+};
+
+static RangeMaskKernel selectRangeMaskKernel() {
+#ifdef RANGE_MASK_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {rangeMaskAvx2, "avx2"};
+    if (__builtin_cpu_supports("sse2")) return {rangeMaskSse2, "sse2"};
+#endif
+    return {rangeMaskScalar, "scalar"};
+}
+
+static const RangeMaskKernel& rangeMaskKernel() {
+    static const RangeMaskKernel kernel = selectRangeMaskKernel();
+    return kernel;
+}
+
+size_t rangeMask(int cx, int cy, int range, const int* xs, const int* ys, size_t n, uint64_t* mask) {
+    return rangeMaskKernel().fn(cx, cy, range, xs, ys, n, mask);
+}
+
+const char* rangeMaskKernelName() {
+    return rangeMaskKernel().name;
+}
+
+SpatialGrid::SpatialGrid(int width, int height, int cellSize) :
+    cellSize(std::max(cellSize, 1)),
+    cols(std::max((width + this->cellSize - 1) / this->cellSize, 1)),
+    rows(std::max((height + this->cellSize - 1) / this->cellSize, 1)),
+    cellStart(static_cast<size_t>(cols) * rows + 1, 0) {}
+
+void SpatialGrid::rebuild(const EnemyStore& enemies) {
+    const size_t n = enemies.size();
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    entryCell.resize(n);
+
+    //     (     )
+    for (size_t i = 0; i < n; i++) {
+        if (!enemies.isAlive(i) || enemies.leaked[i]) {
+            entryCell[i] = UINT32_MAX;
+            continue;
+        }
+        uint32_t cell = static_cast<uint32_t>(cellOf(enemies.x[i], enemies.y[i]));
+        entryCell[i] = cell;
+        cellStart[cell + 1]++;
+    }
+    for (size_t c = 1; c < cellStart.size(); c++) {
+        cellStart[c] += cellStart[c - 1];
+    }
+
+    //       
+    const uint32_t total = cellStart.back();
+    entries.resize(total);
+    entryX.resize(total);
+    entryY.resize(total);
+    cellCursor.assign(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t cell = entryCell[i];
+        if (cell == UINT32_MAX) continue;
+        uint32_t k = cellCursor[cell]++;
+        entries[k] = static_cast<uint32_t>(i);
+        entryX[k] = enemies.x[i];
+        entryY[k] = enemies.y[i];
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+struct EnemyStore;
+
+//   :  (xs[i], ys[i]), i < n,    range
+//   (cx, cy).  i  mask[i / 64]    (dx*dx + dy*dy <= range*range),
+//  mask   (n + 63) / 64 .   .
+//  (AVX2, SSE2  )       .
+size_t rangeMask(int cx, int cy, int range, const int* xs, const int* ys, size_t n, uint64_t* mask);
+size_t rangeMaskScalar(int cx, int cy, int range, const int* xs, const int* ys, size_t n, uint64_t* mask);
+const char* rangeMaskKernelName();
+
+//     .      ,
+//  :      ,   .
+class SpatialGrid {
+private:
+    int cellSize;
+    int cols, rows;
+    std::vector<uint32_t> cellStart; //    entries, cols * rows + 1 
+    std::vector<uint32_t> entries;   //  ,   
+    std::vector<int> entryX, entryY; //     ,     EnemyStore
+    std::vector<uint32_t> entryCell;  //      
+    std::vector<uint32_t> cellCursor;
+
+    int cellOf(int x, int y) const {
+        int cx = std::min(std::max(x / cellSize, 0), cols - 1);
+        int cy = std::min(std::max(y / cellSize, 0), rows - 1);
+        return cy * cols + cx;
+    }
+
+public:
+    SpatialGrid(int width, int height, int cellSize);
+    void rebuild(const EnemyStore& enemies);
+
+    // fn(i)    i  dx*dx + dy*dy <= radius*radius
+    template <class Fn>
+    void forEachInRadius(int x, int y, int radius, Fn fn) const {
+        if (radius < 0) return;
+        const size_t CHUNK = 256;
+        uint64_t mask[CHUNK / 64];
+        const int cx0 = std::max((x - radius) / cellSize, 0);
+        const int cy0 = std::max((y - radius) / cellSize, 0);
+        const int cx1 = std::min((x + radius) / cellSize, cols - 1);
+        const int cy1 = std::min((y + radius) / cellSize, rows - 1);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            //     
+            const uint32_t begin = cellStart[cy * cols + cx0];
+            const uint32_t end = cellStart[cy * cols + cx1 + 1];
+            for (uint32_t k = begin; k < end; k += CHUNK) {
+                size_t n = std::min<size_t>(CHUNK, end - k);
+                if (rangeMask(x, y, radius, &entryX[k], &entryY[k], n, mask) == 0) continue;
+                for (size_t w = 0; w < (n + 63) / 64; w++) {
+                    for (uint64_t bits = mask[w]; bits != 0; bits &= bits - 1) {
+                        fn(entries[k + w * 64 + __builtin_ctzll(bits)]);
+                    }
+                }
+            }
+        }
+    }
+};
+
+#endif // SPATIAL_H
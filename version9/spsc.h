@@ -0,0 +1,42 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <atomic>
+#include <cstddef>
+
+//          .
+// Capacity -  ;   ,    -  
+template <class T, size_t Capacity>
+class SpscQueue {
+private:
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+    T items[Capacity];
+    alignas(64) std::atomic<size_t> head; //   ,   
+    alignas(64) std::atomic<size_t> tail; //   ,   
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // . false -  ,   
+    bool push(const T& item) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) return false;
+        items[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // . false -  
+    bool pop(T& item) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = items[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif // SPSC_H
@@ -0,0 +1,75 @@
+#ifndef STENCIL_H
+#define STENCIL_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+//  :    r    dy  [-r, r] -  halfWidth,
+//   - dx  [-halfWidth, halfWidth]  dx*dx + dy*dy <= r*r.
+//    ,   -       .
+constexpr int MAX_STENCIL_RADIUS = 16;
+
+struct DiskStencil {
+    int radius;
+    int8_t halfWidth[2 * MAX_STENCIL_RADIUS + 1]; //  dy + radius
+};
+
+constexpr DiskStencil makeDiskStencil(int r) {
+    DiskStencil s{};
+    s.radius = r;
+    for (int dy = -r; dy <= r; dy++) {
+        int hw = 0;
+        while ((hw + 1) * (hw + 1) + dy * dy <= r * r) hw++;
+        s.halfWidth[dy + r] = static_cast<int8_t>(hw);
+    }
+    return s;
+}
+
+template <size_t... R>
+constexpr std::array<DiskStencil, sizeof...(R)> makeDiskStencils(std::index_sequence<R...>) {
+    return {{makeDiskStencil(static_cast<int>(R))...}};
+}
+
+constexpr std::array<DiskStencil, MAX_STENCIL_RADIUS + 1> DISK_STENCILS =
+    makeDiskStencils(std::make_index_sequence<MAX_STENCIL_RADIUS + 1>{});
+
+static_assert(DISK_STENCILS[1].halfWidth[1] == 1 && DISK_STENCILS[1].halfWidth[0] == 0, "bad disk stencil");
+static_assert(DISK_STENCILS[10].halfWidth[10 + 6] == 8, "bad disk stencil");
+
+//   dy   r;      
+inline int diskHalfWidth(int r, int dy) {
+    if (r <= MAX_STENCIL_RADIUS) return DISK_STENCILS[r].halfWidth[dy + r];
+    int hw = static_cast<int>(std::sqrt(static_cast<double>(r) * r - static_cast<double>(dy) * dy));
+    while (hw * hw + dy * dy > r * r) hw--;
+    while ((hw + 1) * (hw + 1) + dy * dy <= r * r) hw++;
+    return hw;
+}
+
+// fn(y, x0, x1)       (cx, cy),    width x height
+template <class Fn>
+void forEachDiskSpan(int cx, int cy, int r, int width, int height, Fn fn) {
+    if (r < 0) return;
+    const int dy0 = std::max(-r, -cy);
+    const int dy1 = std::min(r, height - 1 - cy);
+    for (int dy = dy0; dy <= dy1; dy++) {
+        const int hw = diskHalfWidth(r, dy);
+        const int x0 = std::max(cx - hw, 0);
+        const int x1 = std::min(cx + hw, width - 1);
+        if (x0 <= x1) fn(cy + dy, x0, x1);
+    }
+}
+
+// fn(x, y)      
+template <class Fn>
+void forEachDiskCell(int cx, int cy, int r, int width, int height, Fn fn) {
+    forEachDiskSpan(cx, cy, r, width, height, [&](int y, int x0, int x1) {
+        for (int x = x0; x <= x1; x++) {
+            fn(x, y);
+        }
+    });
+}
+
+#endif // STENCIL_H
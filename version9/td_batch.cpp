@@ -0,0 +1,276 @@
+#include "sim.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+//    :      
+// td_batch --runs 1000 --levels 1,2,3 --threads 64 --max-ticks 200000 --seed 1
+
+enum Layout {
+    LAYOUT_NONE,      //  
+    LAYOUT_RANDOM,    //   
+    LAYOUT_NEAR_PATH, //     
+    LAYOUT_ENTRANCE,  //    ,    
+    LAYOUT_COVERAGE,  // ,       
+    LAYOUT_COUNT
+};
+
+static const char* layoutName(int layout) {
+    switch (layout) {
+        case LAYOUT_NONE: return "none";
+        case LAYOUT_RANDOM: return "random";
+        case LAYOUT_NEAR_PATH: return "near-path";
+        case LAYOUT_ENTRANCE: return "entrance";
+        case LAYOUT_COVERAGE: return "coverage";
+        default: return "?";
+    }
+}
+
+struct Job {
+    int level;
+    int layout;
+    uint64_t seed;
+};
+
+struct RunResult {
+    int wave = 0;
+    int leaks = 0;
+    int kills = 0;
+    int towers = 0;
+    long long ticks = 0;
+    double nsPerTick = 0.0;
+    std::vector<int> goldAtWave;
+};
+
+// ,       
+static std::vector<std::pair<int, int>> towerSites(const Map& map, int layout, Rng& rng) {
+    std::vector<std::pair<int, int>> sites;
+    if (layout == LAYOUT_NONE) return sites;
+
+    const int W = map.getWidth();
+    const int H = map.getHeight();
+    const int reach = 2;
+
+    //    -      reach
+    std::vector<int> nearest(static_cast<size_t>(W) * H, INT_MAX);
+    const auto& path = map.getPath();
+    for (size_t i = 0; i < path.size(); i++) {
+        for (int dy = -reach; dy <= reach; dy++) {
+            for (int dx = -reach; dx <= reach; dx++) {
+                int x = path[i].first + dx;
+                int y = path[i].second + dy;
+                if (x < 0 || x >= W || y < 0 || y >= H) continue;
+                int& n = nearest[static_cast<size_t>(y) * W + x];
+                n = std::min(n, static_cast<int>(i));
+            }
+        }
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (!map.canPlaceTower(x, y)) continue;
+            if (layout != LAYOUT_RANDOM && layout != LAYOUT_COVERAGE && nearest[static_cast<size_t>(y) * W + x] == INT_MAX) continue;
+            sites.push_back({x, y});
+        }
+    }
+
+    //  -
+    for (size_t i = sites.size(); i > 1; i--) {
+        std::swap(sites[i - 1], sites[rng.nextBelow(static_cast<uint32_t>(i))]);
+    }
+
+    if (layout == LAYOUT_ENTRANCE) {
+        std::stable_sort(sites.begin(), sites.end(),
+            [&](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                return nearest[static_cast<size_t>(a.second) * W + a.first] <
+                       nearest[static_cast<size_t>(b.second) * W + b.first];
+            });
+    } else if (layout == LAYOUT_COVERAGE) {
+        //      ,     
+        const int range = TOWER_ARCHETYPES[TOWER_BASIC].range;
+        std::vector<int> coverage(static_cast<size_t>(W) * H, 0);
+        for (const auto& site : sites) {
+            coverage[static_cast<size_t>(site.second) * W + site.first] = map.pathCellsInRange(site.first, site.second, range);
+        }
+        std::stable_sort(sites.begin(), sites.end(),
+            [&](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                return coverage[static_cast<size_t>(a.second) * W + a.first] >
+                       coverage[static_cast<size_t>(b.second) * W + b.first];
+            });
+    }
+    return sites;
+}
+
+static RunResult runJob(const Job& job, int width, int height, long long maxTicks) {
+    Simulation sim(width, height, job.level, job.seed);
+    Rng layoutRng(job.seed, 2); //  ,     
+    std::vector<std::pair<int, int>> sites = towerSites(sim.getMap(), job.layout, layoutRng);
+    size_t nextSite = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    while (sim.getTickCount() < maxTicks && sim.getPlayer().isAlive()) {
+        //    ,    
+        while (nextSite < sites.size() &&
+               sim.buildTower(sites[nextSite].first, sites[nextSite].second)) {
+            nextSite++;
+        }
+        sim.update();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    RunResult result;
+    result.wave = sim.getCurrentWave();
+    result.leaks = sim.getStats().leaks;
+    result.kills = sim.getStats().kills;
+    result.towers = sim.getStats().towersBuilt;
+    result.ticks = sim.getTickCount();
+    result.nsPerTick = result.ticks > 0 ? elapsed.count() / result.ticks : 0.0;
+    result.goldAtWave = sim.getStats().goldAtWave;
+    return result;
+}
+
+//    ,   1  3     .
+// false -     
+static bool parseLevels(const char* text, std::vector<int>& levels) {
+    levels.clear();
+    const char* p = text;
+    while (true) {
+        char* end;
+        long level = std::strtol(p, &end, 10);
+        if (end == p || level < 1 || level > 3) return false;
+        if (std::find(levels.begin(), levels.end(), level) != levels.end()) return false;
+        levels.push_back(static_cast<int>(level));
+        if (*end == '\0') return true;
+        if (*end != ',') return false;
+        p = end + 1;
+    }
+}
+
+static void usage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [--runs N] [--levels 1,2,3] [--threads N] [--max-ticks N]\n"
+        "          [--seed N] [--width N] [--height N]\n", prog);
+}
+
+int main(int argc, char** argv) {
+    int runs = 100;
+    std::vector<int> levels = {1, 2, 3};
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    long long maxTicks = 200000;
+    uint64_t baseSeed = 1;
+    int width = 150;
+    int height = 55;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (std::strcmp(argv[i], "--runs") == 0) {
+            runs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--levels") == 0) {
+            if (!parseLevels(argv[++i], levels)) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-ticks") == 0) {
+            maxTicks = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            baseSeed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--width") == 0) {
+            width = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--height") == 0) {
+            height = std::atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (runs <= 0 || levels.empty() || width < 3 || height < 3) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (threads <= 0) threads = 1;
+
+    //    x  x seed
+    std::vector<Job> jobs;
+    for (int level : levels) {
+        for (int layout = 0; layout < LAYOUT_COUNT; layout++) {
+            for (int r = 0; r < runs; r++) {
+                jobs.push_back({level, layout, baseSeed + static_cast<uint64_t>(r)});
+            }
+        }
+    }
+
+    //    :    ,    
+    std::vector<RunResult> results(jobs.size());
+    auto start = std::chrono::steady_clock::now();
+    {
+        JobSystem scheduler(threads);
+        scheduler.parallelFor(jobs.size(), 1, [&](size_t i, size_t, size_t) {
+            results[i] = runJob(jobs[i], width, height, maxTicks);
+        });
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    //     /
+    const int goldWaves[] = {2, 5, 10};
+    std::printf("%-14s %-10s %5s %6s %4s %4s %7s %7s %6s %8s %8s %8s %9s\n",
+                "level", "layout", "runs", "wave", "min", "max", "leaks", "kills", "towers",
+                "gold@w2", "gold@w5", "gold@w10", "ns/tick");
+
+    long long totalTicks = 0;
+    for (int level : levels) {
+        Map map(width, height, level);
+        for (int layout = 0; layout < LAYOUT_COUNT; layout++) {
+            int count = 0, minWave = INT_MAX, maxWave = 0;
+            double wave = 0, leaks = 0, kills = 0, towers = 0, nsPerTick = 0;
+            double gold[3] = {0, 0, 0};
+            int goldRuns[3] = {0, 0, 0};
+
+            for (size_t i = 0; i < jobs.size(); i++) {
+                if (jobs[i].level != level || jobs[i].layout != layout) continue;
+                const RunResult& r = results[i];
+                count++;
+                wave += r.wave;
+                minWave = std::min(minWave, r.wave);
+                maxWave = std::max(maxWave, r.wave);
+                leaks += r.leaks;
+                kills += r.kills;
+                towers += r.towers;
+                nsPerTick += r.nsPerTick;
+                totalTicks += r.ticks;
+                for (int g = 0; g < 3; g++) {
+                    if (static_cast<int>(r.goldAtWave.size()) >= goldWaves[g]) {
+                        gold[g] += r.goldAtWave[goldWaves[g] - 1];
+                        goldRuns[g]++;
+                    }
+                }
+            }
+            if (count == 0) continue;
+
+            std::printf("%-14s %-10s %5d %6.2f %4d %4d %7.1f %7.1f %6.1f",
+                        map.getLevelName(), layoutName(layout), count, wave / count, minWave, maxWave,
+                        leaks / count, kills / count, towers / count);
+            for (int g = 0; g < 3; g++) {
+                if (goldRuns[g] > 0) {
+                    std::printf(" %8.0f", gold[g] / goldRuns[g]);
+                } else {
+                    std::printf(" %8s", "-");
+                }
+            }
+            std::printf(" %9.0f\n", nsPerTick / count);
+        }
+    }
+
+    double seconds = elapsed.count();
+    std::printf("\n%zu runs on %d threads in %.2f s, %.0f ticks/sec total\n",
+                jobs.size(), threads, seconds, seconds > 0.0 ? totalTicks / seconds : 0.0);
+    return 0;
+}
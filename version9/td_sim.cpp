@@ -0,0 +1,83 @@
+#include "sim.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+//   : td_sim --level 2 --ticks 1000000 --seed 42
+//      Simulation::update (Simulation::TICK_MS  )
+
+static void usage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [--level N] [--ticks N] [--seed N] [--width N] [--height N] [--threads N]\n", prog);
+}
+
+int main(int argc, char** argv) {
+    int level = DEFAULT_LEVEL;
+    long long ticks = 1000000;
+    unsigned long long seed = 1;
+    int width = 150;
+    int height = 55;
+    int threads = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (std::strcmp(argv[i], "--level") == 0) {
+            level = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--ticks") == 0) {
+            ticks = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--width") == 0) {
+            width = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--height") == 0) {
+            height = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            threads = std::atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (level < 0 || level > 3 || width < 3 || height < 3 || ticks < 0 || threads < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    JobSystem jobs(threads);
+    Simulation sim(width, height, level, seed, &jobs);
+
+    //    --ticks     ,    
+    long long gameOverTick = -1;
+    auto start = std::chrono::steady_clock::now();
+    while (sim.getTickCount() < ticks) {
+        sim.update();
+        if (gameOverTick < 0 && !sim.getPlayer().isAlive()) {
+            gameOverTick = sim.getTickCount();
+        }
+    }
+    long long tick = sim.getTickCount();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double seconds = elapsed.count();
+    std::printf("level: %s\n", sim.getMap().getLevelName());
+    std::printf("range kernel: %s\n", rangeMaskKernelName());
+    std::printf("threads: %d\n", sim.getThreadCount());
+    std::printf("ticks: %lld\n", tick);
+    if (gameOverTick >= 0) {
+        std::printf("game over at tick: %lld\n", gameOverTick);
+    }
+    std::printf("wave: %d\n", sim.getCurrentWave());
+    std::printf("health: %d\n", sim.getPlayer().getHealth());
+    std::printf("money: %d\n", sim.getPlayer().getMoney());
+    std::printf("kills: %d\n", sim.getStats().kills);
+    std::printf("leaks: %d\n", sim.getStats().leaks);
+    std::printf("peak enemies: %zu / %zu\n", sim.getEnemyPoolStats().peak, sim.getEnemyPoolStats().capacity);
+    std::printf("peak towers: %zu / %zu\n", sim.getTowerPoolStats().peak, sim.getTowerPoolStats().capacity);
+    std::printf("time: %.3f s\n", seconds);
+    std::printf("ticks/sec: %.0f\n", seconds > 0.0 ? tick / seconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+//          .
+//         ,   ,
+//     .    :     
+// ,        .
+template <class T>
+class TripleBuffer {
+private:
+    static const uint8_t INDEX_MASK = 3;
+    static const uint8_t FRESH = 4; //    ,    
+
+    T buffers[3];
+    std::atomic<uint8_t> middle; //      FRESH
+    uint8_t back;  //  
+    uint8_t front; //  
+
+public:
+    TripleBuffer() : middle(1), back(0), front(2) {}
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // :   .   -    
+    T& writeBuffer() { return buffers[back]; }
+    void publish() {
+        back = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // :   ,   . false -   
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    const T& readBuffer() const { return buffers[front]; }
+};
+
+#endif // TRIPLEBUFFER_H